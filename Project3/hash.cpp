@@ -12,16 +12,87 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <cstring>
+#include <algorithm>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// software prefetch hint; a no-op on compilers without the builtin
+#ifdef __GNUC__
+#define HASH_PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define HASH_PREFETCH(addr) ((void)(addr))
+#endif
+
+// number of keys searchBatch hashes and prefetches ahead of resolving
+static const unsigned int BATCH_WINDOW = 16;
+
+// counters touched per key in the membership filter
+static const unsigned int FILTER_PROBES = 3;
+
+// largest filter count; a saturated counter is never decremented
+static const unsigned char FILTER_MAX = 255;
+
+// first bytes of every file written by Hash::save
+static const char SNAPSHOT_MAGIC[8] = {'H', 'A', 'S', 'H', 'S', 'N', 'P', '1'};
+
+/*
+ * Layout of a snapshot file, all in native byte order:
+ *    SnapshotHeader
+ *    unsigned int start[HASH_TABLE_SIZE + 1]   first KeyRef of each container
+ *    KeyRef refs[keyCount]                     offsets are into the key bytes
+ *    char keys[arenaSize]                      every key, back to back
+ */
+struct SnapshotHeader {
+   char magic[8];
+   unsigned int tableSize;          // HASH_TABLE_SIZE of the writer
+   unsigned int keyCount;
+   unsigned int arenaSize;
+   unsigned int nonEmptyLists;
+   unsigned int longestList;
+   int collisions;
+   double runningAvgListLength;
+};
 
 /*
  * @brief Default constructor.
  * 
- * Sets collisions, longestList, and runningAvgListLength to 0.
+ * Stores keys in LIST mode.
+ */
+Hash::Hash() : Hash(LIST) {}
+
+/*
+ * @brief Constructor selecting how keys are stored.
+ * @param storage, LIST for one std::string per list node, or ARENA to
+ *          pack every key into one contiguous buffer.
+ *
+ * ARENA trades the per-node string and list overhead for a 12 byte
+ * KeyRef per key plus the key bytes themselves. Sets collisions,
+ * longestList, runningAvgListLength and the counters to 0.
  */
-Hash::Hash() {
+Hash::Hash(StorageMode storage) {
    collisions = 0;
    longestList = 0;
    runningAvgListLength = 0;
+   mode = storage;
+   itemsInLists = 0;
+   nonEmptyLists = 0;
+   mapped = nullptr;
+   mappedSize = 0;
+   filterChecks = 0;
+   filterRejects = 0;
+   filterFalsePositives = 0;
+}
+
+/*
+ * @brief Destructor.
+ *
+ * Unmaps the snapshot if the table was loaded from one.
+ */
+Hash::~Hash() {
+   unmap();
 }
 
 /*
@@ -31,16 +102,35 @@ Hash::Hash() {
  * Uses the hash function to determine the index of the container
  * to search the list at that array for the given string. Upon
  * successful removal the runningAvgListLength will be recalculated.
+ * In ARENA mode only the KeyRef is dropped; the key bytes stay in
+ * keyArena since it is append-only. A MAPPED table is copied into
+ * ARENA storage first.
  */
 void Hash::remove(string word) {
+   thaw();
    int index = hf(word);
-   for(list<string>::iterator it = hashTable[index].begin();
-         it != hashTable[index].end(); it++) {
-      if(*it == word) {
-         hashTable[index].remove(word);
-         averageItOut();
-         break;
+   unsigned int before = listSize(index);
+   unsigned int hash = keyHash(word);
+   if(mode == ARENA) {
+      vector<KeyRef>& bucket = arenaTable[index];
+      for(unsigned int i = 0; i < bucket.size(); ) {
+         if(matches(bucket[i], word, hash)) {
+            bucket.erase(bucket.begin() + i);
+         } else {
+            i++;
+         }
       }
+   } else {
+      hashTable[index].remove(word);
+   }
+   unsigned int after = listSize(index);
+   if(after != before) {
+      filterAdd(hash, -(int)(before - after));
+      itemsInLists -= before - after;
+      if(after == 0) {
+         nonEmptyLists--;
+      }
+      averageItOut();
    }
 }
 
@@ -54,10 +144,7 @@ void Hash::remove(string word) {
 void Hash::print() {
    for(int i = 0; i < HASH_TABLE_SIZE; i++) {
       std::cout << i << ":\t";
-      for(list<string>::iterator it = hashTable[i].begin();
-            it != hashTable[i].end(); it++) {
-              std::cout << *it << ", ";
-            }
+      writeList(std::cout, i);
       std::cout << "\n";
    }
 }
@@ -74,22 +161,13 @@ void Hash::print() {
  * called to get the runningAvgListLength updated.
  */
 void Hash::processFile(string fileName) {
+   thaw();
    string line;
    std::ifstream newFile;
    newFile.open(fileName);
    if(newFile.is_open()) {
       while(getline(newFile, line)) {
-         int index = hf(line);
-         if(!hashTable[index].empty()) {
-            collisions++;
-         }
-         hashTable[index].push_back(line);
-         averageItOut();
-         for(int i = 0; i < HASH_TABLE_SIZE; i++) {
-            if(hashTable[i].size() > longestList) {
-               longestList = hashTable[i].size();
-            }
-         }
+         insert(line);
       }
    }
    newFile.close();
@@ -101,17 +179,66 @@ void Hash::processFile(string fileName) {
  * @return if string is found return true, otherwise return false.
  * 
  * Uses the hash function on the given string to determine
- * the index of the container the string would be in.
+ * the index of the container the string would be in. When the
+ * membership filter is on it is asked first, and the container is
+ * only walked if the filter says the string may be present.
  */
 bool Hash::search(string word) {
    int index = hf(word);
-   for(list<string>::iterator it = hashTable[index].begin();
-         it != hashTable[index].end(); it++) {
-      if(*it == word) {
-         return true;
+   unsigned int hash = 0;
+   if(mode != LIST || !filter.empty()) {
+      hash = keyHash(word);
+   }
+   if(!filterMayContain(hash)) {
+      return false;
+   }
+   return findKey(index, word, hash);
+}
+
+/*
+ * @brief Searches the hash table for many strings at once.
+ * @param words, pointer to the first of the strings to search for.
+ * @param count, the number of strings starting at words.
+ * @return a vector holding search(words[i]) at position i.
+ *
+ * Works through the keys BATCH_WINDOW at a time. Every key in a window
+ * is hashed and its container prefetched, then the first entries of
+ * each container are prefetched, and only then are the containers
+ * walked, so the cache misses of a window overlap instead of each
+ * search stalling on its own. Keys the membership filter rejects are
+ * never prefetched or walked.
+ */
+vector<bool> Hash::searchBatch(const string* words, unsigned int count) {
+   vector<bool> found(count, false);
+   int index[BATCH_WINDOW];
+   unsigned int hash[BATCH_WINDOW];
+   for(unsigned int start = 0; start < count; start += BATCH_WINDOW) {
+      unsigned int n = count - start;
+      if(n > BATCH_WINDOW) {
+         n = BATCH_WINDOW;
+      }
+      for(unsigned int i = 0; i < n; i++) {
+         index[i] = hf(words[start + i]);
+         prefetchList(index[i]);
+      }
+      for(unsigned int i = 0; i < n; i++) {
+         hash[i] = 0;
+         if(mode != LIST || !filter.empty()) {
+            hash[i] = keyHash(words[start + i]);
+         }
+         if(filterMayContain(hash[i])) {
+            prefetchKeys(index[i]);
+         } else {
+            index[i] = -1;
+         }
+      }
+      for(unsigned int i = 0; i < n; i++) {
+         if(index[i] >= 0) {
+            found[start + i] = findKey(index[i], words[start + i], hash[i]);
+         }
       }
    }
-   return false;
+   return found;
 }
 
 /*
@@ -127,10 +254,7 @@ void Hash::output(string fileName) {
    newFile.open(fileName);
    for(int i = 0; i < HASH_TABLE_SIZE; i++) {
       newFile << i << ":\t";
-      for(list<string>::iterator it = hashTable[i].begin();
-            it != hashTable[i].end(); it++) {
-               newFile << *it << ", ";
-            }
+      writeList(newFile, i);
       newFile << std::endl;  
    }
    newFile.close();
@@ -142,7 +266,9 @@ void Hash::output(string fileName) {
  *
  * Prints the collisions, longestList, runningAvgListLength, kept track
  * of throughout the program. Calculates and prints the load factor
- * for the final table.
+ * for the final table. If the membership filter is on, also prints
+ * how many lookups it answered on its own and what fraction of the
+ * missing keys it failed to reject.
  */
 void Hash::printStats() {
    std::cout << "Total Collisions = " << collisions << "\n";
@@ -150,14 +276,33 @@ void Hash::printStats() {
    std::cout << "Average List Length Over Time = " 
                   << runningAvgListLength << "\n";
    double load = 0;
-   int itemsInLists = 0;
-      for(int i = 0; i < HASH_TABLE_SIZE; i++) {
-         if(hashTable[i].size() > 0) {
-            itemsInLists = itemsInLists + hashTable[i].size();
-         }
-      }
    load = ((double)itemsInLists) / ((double)HASH_TABLE_SIZE);
    std::cout << "Load Factor = " << load << "\n";
+   if(!filter.empty()) {
+      std::cout << "Filter Checks = " << filterChecks << "\n";
+      std::cout << "Filter Rejects = " << filterRejects << "\n";
+      std::cout << "Filter False Positives = " << filterFalsePositives << "\n";
+      unsigned int absent = filterRejects + filterFalsePositives;
+      double rate = 0;
+      if(absent > 0) {
+         rate = ((double)filterFalsePositives) / ((double)absent);
+      }
+      std::cout << "Filter False Positive Rate = " << rate << "\n";
+   }
+}
+
+/*
+ * @brief Gets the length of every container.
+ * @return a vector with the number of keys in container i at index i.
+ *
+ * Used to judge how evenly the hash function spreads the keys.
+ */
+vector<unsigned int> Hash::listLengths() {
+   vector<unsigned int> lengths(HASH_TABLE_SIZE);
+   for(int i = 0; i < HASH_TABLE_SIZE; i++) {
+      lengths[i] = listSize(i);
+   }
+   return lengths;
 }
 
 /*
@@ -167,17 +312,452 @@ void Hash::printStats() {
  * Computes the current list length by dividing the number of items
  * in the lists, by the number of nonempty lists, then updates the
  * running average by adding the running average to the current
- * average and dividing by two.
+ * average and dividing by two. Both counts are kept up to date by
+ * insert and remove so this does not have to walk the table.
  */
 void Hash::averageItOut() {
-   int nonEmptyLists = 0;
-   int itemsInLists = 0;
+   double currentListAvg = 0;
+   if(nonEmptyLists > 0) {
+      currentListAvg = ((double)itemsInLists) / ((double)nonEmptyLists);
+   }
+   runningAvgListLength = (runningAvgListLength + currentListAvg)/2;
+}
+
+/*
+ * @brief Gets the number of keys in one container.
+ * @param index, the container to measure.
+ * @return the length of the list or KeyRef vector at index.
+ */
+unsigned int Hash::listSize(int index) {
+   if(mode == MAPPED) {
+      return mappedStart[index + 1] - mappedStart[index];
+   }
+   if(mode == ARENA) {
+      return arenaTable[index].size();
+   }
+   return hashTable[index].size();
+}
+
+/*
+ * @brief Gets the KeyRefs of one container in ARENA or MAPPED mode.
+ * @param index, the container to look at.
+ * @return pointer to the first of listSize(index) KeyRefs.
+ */
+const Hash::KeyRef* Hash::listRefs(int index) {
+   if(mode == MAPPED) {
+      return mappedRefs + mappedStart[index];
+   }
+   return arenaTable[index].data();
+}
+
+/*
+ * @brief Gets the key bytes the KeyRefs point into.
+ * @return the mapped key bytes in MAPPED mode, keyArena otherwise.
+ */
+const char* Hash::keyBytes() {
+   if(mode == MAPPED) {
+      return mappedKeys;
+   }
+   return keyArena.data();
+}
+
+/*
+ * @brief Looks for a key in one container.
+ * @param index, hf(word).
+ * @param word, the string being looked for.
+ * @param hash, keyHash(word); unused in LIST mode.
+ * @return true if the container holds word.
+ *
+ * A miss after the filter let the lookup through is counted as a
+ * filter false positive.
+ */
+bool Hash::findKey(int index, const string& word, unsigned int hash) {
+   if(mode == LIST) {
+      for(list<string>::iterator it = hashTable[index].begin();
+            it != hashTable[index].end(); it++) {
+         if(*it == word) {
+            return true;
+         }
+      }
+      if(!filter.empty()) {
+         filterFalsePositives++;
+      }
+      return false;
+   }
+   const KeyRef* refs = listRefs(index);
+   unsigned int size = listSize(index);
+   for(unsigned int i = 0; i < size; i++) {
+      if(matches(refs[i], word, hash)) {
+         return true;
+      }
+   }
+   if(!filter.empty()) {
+      filterFalsePositives++;
+   }
+   return false;
+}
+
+/*
+ * @brief Writes one container as a comma separated list.
+ * @param out, the stream to write to.
+ * @param index, the container to write.
+ *
+ * Shared by print and output.
+ */
+void Hash::writeList(std::ostream& out, int index) {
+   if(mode == LIST) {
+      for(list<string>::iterator it = hashTable[index].begin();
+            it != hashTable[index].end(); it++) {
+         out << *it << ", ";
+      }
+      return;
+   }
+   const KeyRef* refs = listRefs(index);
+   unsigned int size = listSize(index);
+   for(unsigned int i = 0; i < size; i++) {
+      out.write(keyBytes() + refs[i].offset, refs[i].length);
+      out << ", ";
+   }
+}
+
+/*
+ * @brief Checks whether a stored key equals a given string.
+ * @param ref, the KeyRef pointing at the stored key.
+ * @param word, the string being looked for.
+ * @param hash, keyHash(word), computed once by the caller.
+ * @return true if the stored bytes equal word.
+ *
+ * The cached hash and length are compared first so most mismatches
+ * never touch the key bytes.
+ */
+bool Hash::matches(const KeyRef& ref, const string& word, unsigned int hash) {
+   return ref.hash == hash && ref.length == word.length() &&
+          memcmp(keyBytes() + ref.offset, word.data(), ref.length) == 0;
+}
+
+/*
+ * @brief Adds one key to the table.
+ * @param word, the key to add.
+ *
+ * Checks for a collision, appends the key to the container picked by
+ * the hash function, and updates the statistics. Only the container
+ * that grew can have become the longest list.
+ */
+void Hash::insert(const string& word) {
+   int index = hf(word);
+   if(listSize(index) > 0) {
+      collisions++;
+   } else {
+      nonEmptyLists++;
+   }
+   if(mode == ARENA) {
+      KeyRef ref;
+      ref.offset = keyArena.size();
+      ref.length = word.length();
+      ref.hash = keyHash(word);
+      keyArena.append(word);
+      arenaTable[index].push_back(ref);
+      filterAdd(ref.hash, 1);
+   } else {
+      hashTable[index].push_back(word);
+      if(!filter.empty()) {
+         filterAdd(keyHash(word), 1);
+      }
+   }
+   itemsInLists++;
+   averageItOut();
+   if(listSize(index) > longestList) {
+      longestList = listSize(index);
+   }
+}
+
+/*
+ * @brief Prefetches the container at a given index.
+ * @param index, the container searchBatch is about to look at.
+ */
+void Hash::prefetchList(int index) {
+   if(mode == MAPPED) {
+      HASH_PREFETCH(&mappedStart[index]);
+   } else if(mode == ARENA) {
+      HASH_PREFETCH(&arenaTable[index]);
+   } else {
+      HASH_PREFETCH(&hashTable[index]);
+   }
+}
+
+/*
+ * @brief Prefetches the first entry of the container at a given index.
+ * @param index, a container already passed to prefetchList.
+ *
+ * The KeyRefs are requested, or the first list node in LIST mode.
+ * Key bytes are only read after the cached hash matches.
+ */
+void Hash::prefetchKeys(int index) {
+   if(mode != LIST) {
+      if(listSize(index) > 0) {
+         HASH_PREFETCH(listRefs(index));
+      }
+   } else if(!hashTable[index].empty()) {
+      HASH_PREFETCH(&hashTable[index].front());
+   }
+}
+
+/*
+ * @brief Writes the hash table to a binary snapshot file.
+ * @param fileName, a string specifying the file to be written.
+ * @return true if the whole snapshot was written.
+ *
+ * Keys are laid out container by container in the format described
+ * at SnapshotHeader, together with the statistics, so load can serve
+ * searches straight from the file. Bytes left behind in keyArena by
+ * remove are not written.
+ */
+bool Hash::save(string fileName) {
+   SnapshotHeader header;
+   memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+   header.tableSize = HASH_TABLE_SIZE;
+   header.keyCount = itemsInLists;
+   header.nonEmptyLists = nonEmptyLists;
+   header.longestList = longestList;
+   header.collisions = collisions;
+   header.runningAvgListLength = runningAvgListLength;
+
+   vector<unsigned int> start(HASH_TABLE_SIZE + 1, 0);
+   vector<KeyRef> refs;
+   refs.reserve(itemsInLists);
+   string keys;
    for(int i = 0; i < HASH_TABLE_SIZE; i++) {
-      if(hashTable[i].size() > 0) {
-         nonEmptyLists++;
-         itemsInLists = itemsInLists + hashTable[i].size();
+      start[i] = refs.size();
+      KeyRef ref;
+      if(mode == LIST) {
+         for(list<string>::iterator it = hashTable[i].begin();
+               it != hashTable[i].end(); it++) {
+            ref.offset = keys.size();
+            ref.length = it->length();
+            ref.hash = keyHash(*it);
+            keys.append(*it);
+            refs.push_back(ref);
+         }
+      } else {
+         const KeyRef* list = listRefs(i);
+         unsigned int size = listSize(i);
+         for(unsigned int j = 0; j < size; j++) {
+            ref = list[j];
+            ref.offset = keys.size();
+            keys.append(keyBytes() + list[j].offset, list[j].length);
+            refs.push_back(ref);
+         }
       }
    }
-   double currentListAvg = ((double)itemsInLists) / ((double)nonEmptyLists);
-   runningAvgListLength = (runningAvgListLength + currentListAvg)/2;
-}
\ No newline at end of file
+   start[HASH_TABLE_SIZE] = refs.size();
+   header.arenaSize = keys.size();
+
+   std::ofstream newFile;
+   newFile.open(fileName, std::ios::binary);
+   newFile.write((const char*)&header, sizeof(header));
+   newFile.write((const char*)start.data(), start.size() * sizeof(unsigned int));
+   newFile.write((const char*)refs.data(), refs.size() * sizeof(KeyRef));
+   newFile.write(keys.data(), keys.size());
+   newFile.close();
+   return !newFile.fail();
+}
+
+/*
+ * @brief Replaces the table with a snapshot written by save.
+ * @param fileName, a string specifying the snapshot file.
+ * @return true if the snapshot was mapped, false if it could not be
+ *          opened, was written with a different HASH_TABLE_SIZE or is
+ *          corrupt, in which case the table is left as it was.
+ *
+ * The file is memory-mapped read-only and the table switches to
+ * MAPPED mode, so search reads the mapped pages directly and nothing
+ * is rehashed. Before that, the container starts are checked to
+ * never decrease and to end at the key count, and every KeyRef to lie
+ * inside the key bytes, so a damaged file cannot send a search out
+ * of bounds. The first processFile or remove copies the keys into
+ * ARENA storage and releases the mapping. A membership filter that
+ * is on is rebuilt from the snapshot.
+ */
+bool Hash::load(string fileName) {
+   int fd = open(fileName.c_str(), O_RDONLY);
+   if(fd < 0) {
+      return false;
+   }
+   struct stat info;
+   void* data = MAP_FAILED;
+   if(fstat(fd, &info) == 0 && (size_t)info.st_size >= sizeof(SnapshotHeader)) {
+      data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+   }
+   close(fd);
+   if(data == MAP_FAILED) {
+      return false;
+   }
+
+   const SnapshotHeader* header = (const SnapshotHeader*)data;
+   size_t expected = sizeof(SnapshotHeader) +
+                     (HASH_TABLE_SIZE + 1) * sizeof(unsigned int) +
+                     (size_t)header->keyCount * sizeof(KeyRef) +
+                     header->arenaSize;
+   if(memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) != 0 ||
+         header->tableSize != HASH_TABLE_SIZE ||
+         (size_t)info.st_size != expected) {
+      munmap(data, info.st_size);
+      return false;
+   }
+   const unsigned int* start = (const unsigned int*)(header + 1);
+   const KeyRef* refs = (const KeyRef*)(start + HASH_TABLE_SIZE + 1);
+   bool valid = start[0] == 0 && start[HASH_TABLE_SIZE] == header->keyCount;
+   for(int i = 0; valid && i < HASH_TABLE_SIZE; i++) {
+      valid = start[i] <= start[i + 1];
+   }
+   for(unsigned int i = 0; valid && i < header->keyCount; i++) {
+      valid = (unsigned long long)refs[i].offset + refs[i].length <= header->arenaSize;
+   }
+   if(!valid) {
+      munmap(data, info.st_size);
+      return false;
+   }
+
+   unmap();
+   for(int i = 0; i < HASH_TABLE_SIZE; i++) {
+      hashTable[i].clear();
+      vector<KeyRef>().swap(arenaTable[i]);
+   }
+   string().swap(keyArena);
+
+   mapped = data;
+   mappedSize = info.st_size;
+   mappedStart = start;
+   mappedRefs = refs;
+   mappedKeys = (const char*)(refs + header->keyCount);
+   mode = MAPPED;
+   itemsInLists = header->keyCount;
+   nonEmptyLists = header->nonEmptyLists;
+   longestList = header->longestList;
+   collisions = header->collisions;
+   runningAvgListLength = header->runningAvgListLength;
+   fillFilter();
+   return true;
+}
+
+/*
+ * @brief Copies a MAPPED table into ARENA storage.
+ *
+ * Called before anything modifies the table. Does nothing unless the
+ * table was loaded from a snapshot.
+ */
+void Hash::thaw() {
+   if(mode != MAPPED) {
+      return;
+   }
+   keyArena.assign(mappedKeys, mappedKeys + ((const SnapshotHeader*)mapped)->arenaSize);
+   for(int i = 0; i < HASH_TABLE_SIZE; i++) {
+      arenaTable[i].assign(listRefs(i), listRefs(i) + listSize(i));
+   }
+   unmap();
+   mode = ARENA;
+}
+
+/*
+ * @brief Releases the snapshot mapping, if there is one.
+ */
+void Hash::unmap() {
+   if(mapped != nullptr) {
+      munmap(mapped, mappedSize);
+      mapped = nullptr;
+      mappedSize = 0;
+   }
+}
+
+/*
+ * @brief Turns the membership filter on, resizes it, or turns it off.
+ * @param counters, the number of filter counters; 0 turns it off.
+ *
+ * The filter is a counting Bloom filter over keyHash values, so
+ * remove can take keys back out of it. About 8 counters per key keeps
+ * false positives near 3%. It is refilled from the current contents
+ * and its statistics restart.
+ */
+void Hash::useFilter(unsigned int counters) {
+   vector<unsigned char>(counters, 0).swap(filter);
+   filterChecks = 0;
+   filterRejects = 0;
+   filterFalsePositives = 0;
+   fillFilter();
+}
+
+/*
+ * @brief Adds a key to the filter or takes it back out.
+ * @param hash, keyHash of the key.
+ * @param copies, how many copies were added (positive) or removed
+ *          (negative).
+ *
+ * Counters saturate at FILTER_MAX and then stay there, which can only
+ * cost false positives, never a missed key.
+ */
+void Hash::filterAdd(unsigned int hash, int copies) {
+   if(filter.empty()) {
+      return;
+   }
+   unsigned int step = (hash >> 16 | hash << 16) * 0x9e3779b1u | 1;
+   unsigned int probe = hash * 0x85ebca6bu;
+   for(unsigned int i = 0; i < FILTER_PROBES; i++, probe += step) {
+      unsigned char& count = filter[probe % filter.size()];
+      if(count == FILTER_MAX) {
+         continue;
+      }
+      int updated = count + copies;
+      if(updated < 0) {
+         updated = 0;
+      } else if(updated > FILTER_MAX) {
+         updated = FILTER_MAX;
+      }
+      count = updated;
+   }
+}
+
+/*
+ * @brief Asks the filter whether a key could be in the table.
+ * @param hash, keyHash of the key.
+ * @return false only if the key is certainly absent; always true when
+ *          the filter is off.
+ */
+bool Hash::filterMayContain(unsigned int hash) {
+   if(filter.empty()) {
+      return true;
+   }
+   filterChecks++;
+   unsigned int step = (hash >> 16 | hash << 16) * 0x9e3779b1u | 1;
+   unsigned int probe = hash * 0x85ebca6bu;
+   for(unsigned int i = 0; i < FILTER_PROBES; i++, probe += step) {
+      if(filter[probe % filter.size()] == 0) {
+         filterRejects++;
+         return false;
+      }
+   }
+   return true;
+}
+
+/*
+ * @brief Clears the filter and adds every key in the table to it.
+ */
+void Hash::fillFilter() {
+   if(filter.empty()) {
+      return;
+   }
+   std::fill(filter.begin(), filter.end(), 0);
+   for(int i = 0; i < HASH_TABLE_SIZE; i++) {
+      if(mode == LIST) {
+         for(list<string>::iterator it = hashTable[i].begin();
+               it != hashTable[i].end(); it++) {
+            filterAdd(keyHash(*it), 1);
+         }
+      } else {
+         const KeyRef* refs = listRefs(i);
+         unsigned int size = listSize(i);
+         for(unsigned int j = 0; j < size; j++) {
+            filterAdd(refs[j].hash, 1);
+         }
+      }
+   }
+}
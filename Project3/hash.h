@@ -15,9 +15,12 @@
 
 #include <string>
 #include <list>
+#include <vector>
+#include <ostream>
 
 using std::string;
 using std::list;
+using std::vector;
 
 class Hash {
 
@@ -42,7 +45,62 @@ private:
 // put additional functions below as needed
 // do not change anything above!
 
+public:
+   // LIST keeps every key in its own std::string inside hashTable;
+   // ARENA appends key bytes to one contiguous buffer and keeps
+   // small (offset, length, hash) records in arenaTable instead.
+   // MAPPED is set by load and serves searches from a snapshot file.
+   enum StorageMode { LIST, ARENA, MAPPED };
+   Hash(StorageMode);               // constructor choosing storage mode
+   ~Hash();                         // destructor
+   Hash(const Hash&) = delete;
+   Hash& operator=(const Hash&) = delete;
+   vector<bool> searchBatch(const string*, unsigned int);  // many searches
+   bool save(string);               // write a binary snapshot to a file
+   bool load(string);               // map a snapshot written by save
+   void useFilter(unsigned int);    // size the membership filter, 0 = off
+   vector<unsigned int> listLengths();    // length of every container
+
+private:
+   // reference to one key stored in keyArena
+   class KeyRef {
+   public:
+      unsigned int offset;          // first byte of the key in keyArena
+      unsigned int length;          // number of bytes in the key
+      unsigned int hash;            // full hash, compared before the bytes
+   };
+
+   StorageMode mode;                // which table holds the keys
+   string keyArena;                 // append-only key bytes (ARENA mode)
+   vector<KeyRef> arenaTable [HASH_TABLE_SIZE];
+   unsigned int itemsInLists;       // keys currently in the table
+   unsigned int nonEmptyLists;      // containers holding at least one key
+   void* mapped;                    // snapshot mapping (MAPPED mode)
+   size_t mappedSize;               // length of the mapping in bytes
+   const unsigned int* mappedStart; // first KeyRef of each container
+   const KeyRef* mappedRefs;        // every KeyRef, container by container
+   const char* mappedKeys;          // key bytes the mapped KeyRefs index
+   vector<unsigned char> filter;    // counting Bloom filter, empty if off
+   unsigned int filterChecks;       // lookups that consulted the filter
+   unsigned int filterRejects;      // lookups the filter answered alone
+   unsigned int filterFalsePositives;  // passed the filter but not found
+
    void averageItOut();             // calculates average list length
+   unsigned int keyHash(const string&);   // unreduced hash for KeyRef
+   unsigned int listSize(int);      // length of one container
+   const KeyRef* listRefs(int);     // KeyRefs of one container
+   const char* keyBytes();          // bytes the KeyRefs point into
+   bool findKey(int, const string&, unsigned int);
+   void writeList(std::ostream&, int);    // print one container
+   bool matches(const KeyRef&, const string&, unsigned int);
+   void insert(const string&);      // add one key to the table
+   void prefetchList(int);          // start loading one container
+   void prefetchKeys(int);          // start loading a container's keys
+   void thaw();                     // copy a MAPPED table into ARENA
+   void filterAdd(unsigned int, int);  // adjust a key's filter counters
+   bool filterMayContain(unsigned int);
+   void fillFilter();               // rebuild the filter from the table
+   void unmap();                    // release the snapshot mapping
 };
 
 #endif
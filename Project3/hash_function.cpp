@@ -31,4 +31,17 @@ int Hash::hf(string word) {
         hashVal %= HASH_TABLE_SIZE;
     }
     return hashVal;
-}
\ No newline at end of file
+}
+
+/*
+ * Same multiplicative hash without reducing by the table size, so
+ * keys that share a container still get different values. ARENA mode
+ * caches it in each KeyRef to skip most byte compares.
+ */
+unsigned int Hash::keyHash(const string& word) {
+    unsigned int hashVal = 0;
+    for(unsigned int i = 0; i < word.length(); i++) {
+        hashVal = 33 * hashVal + (unsigned char)word[i];
+    }
+    return hashVal;
+}
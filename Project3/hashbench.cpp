@@ -0,0 +1,309 @@
+/*
+ * @file hashbench.cpp Measures how fast the Hash table is and how
+ * evenly hf spreads keys over the containers.
+ *
+ * @brief Builds several key sets, loads each one into a Hash through
+ * processFile, then times search and remove. For every set it prints
+ * throughput, latency percentiles, a histogram of list lengths and a
+ * chi-squared uniformity score. Built once per HASH_TABLE_SIZE by the
+ * Makefile.
+ *
+ * Usage: hashbench_<size> [keys] [list|arena], in either order
+ */
+
+#include "hash.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+
+using std::cout;
+using std::vector;
+using std::string;
+
+typedef std::chrono::steady_clock Clock;
+
+// list lengths at or above this share the last histogram bucket
+static const unsigned int HISTOGRAM_BUCKETS = 10;
+
+// adversarial keys are built from this many two-letter blocks
+static const unsigned int COLLISION_BLOCKS = 12;
+
+// keys per processFile call when timing inserts
+static const unsigned int INSERT_BATCH = 1000;
+
+/*
+ * @brief Makes random lowercase words of 2 to 12 letters.
+ *
+ * @param count the number of words to make
+ * @param seed seed for the random generator
+ *
+ * @return the words, not checked for duplicates
+ */
+vector<string> makeWords(unsigned int count, unsigned int seed) {
+   std::mt19937 gen(seed);
+   std::uniform_int_distribution<int> length(2, 12);
+   std::uniform_int_distribution<int> letter('a', 'z');
+   vector<string> keys;
+   for(unsigned int i = 0; i < count; i++) {
+      string word;
+      int n = length(gen);
+      for(int j = 0; j < n; j++) {
+         word += (char)letter(gen);
+      }
+      keys.push_back(word);
+   }
+   return keys;
+}
+
+/*
+ * @brief Reads up to count lines of a word list such as
+ * /usr/share/dict/words.
+ *
+ * @param fileName the word list
+ * @param count the most words to read
+ *
+ * @return the words read, empty if the file could not be opened
+ */
+vector<string> readWords(const string& fileName, unsigned int count) {
+   vector<string> keys;
+   std::ifstream in(fileName);
+   string line;
+   while(keys.size() < count && getline(in, line)) {
+      keys.push_back(line);
+   }
+   return keys;
+}
+
+/*
+ * @brief Makes URL-like keys that share long prefixes.
+ *
+ * @param count the number of keys to make
+ *
+ * @return the keys
+ */
+vector<string> makeUrls(unsigned int count) {
+   vector<string> keys;
+   for(unsigned int i = 0; i < count; i++) {
+      std::ostringstream url;
+      url << "https://host" << i % 97 << ".example.com/catalog/"
+          << i / 97 % 1000 << "/item" << i;
+      keys.push_back(url.str());
+   }
+   return keys;
+}
+
+/*
+ * @brief Makes zero padded sequential ids such as id00000042.
+ *
+ * @param count the number of keys to make
+ *
+ * @return the keys
+ */
+vector<string> makeIds(unsigned int count) {
+   vector<string> keys;
+   char id[32];
+   for(unsigned int i = 0; i < count; i++) {
+      snprintf(id, sizeof(id), "id%08u", i);
+      keys.push_back(id);
+   }
+   return keys;
+}
+
+/*
+ * @brief Makes keys that all get the same hash value.
+ *
+ * @param count the most keys to make
+ *
+ * @return up to 2^COLLISION_BLOCKS keys
+ *
+ * hf and keyHash both compute 33 * hash + c, and "ab" and "bA" both
+ * add 33 * 'a' + 'b' = 33 * 'b' + 'A', so every string made of those
+ * two blocks lands in the same container.
+ */
+vector<string> makeCollisions(unsigned int count) {
+   vector<string> keys;
+   for(unsigned int bits = 0; bits < (1u << COLLISION_BLOCKS) &&
+         keys.size() < count; bits++) {
+      string key;
+      for(unsigned int j = 0; j < COLLISION_BLOCKS; j++) {
+         key += (bits >> j & 1) ? "bA" : "ab";
+      }
+      keys.push_back(key);
+   }
+   return keys;
+}
+
+/*
+ * @brief Prints the rate and latency percentiles of one operation.
+ *
+ * @param name the operation
+ * @param nanos how long each call took, in nanoseconds; sorted here
+ */
+void printTimes(const string& name, vector<double>& nanos) {
+   if(nanos.empty()) {
+      return;
+   }
+   std::sort(nanos.begin(), nanos.end());
+   double total = 0;
+   for(unsigned int i = 0; i < nanos.size(); i++) {
+      total += nanos[i];
+   }
+   cout << "   " << std::left << std::setw(12) << name << std::right
+        << std::setw(10) << (unsigned long)(nanos.size() / (total / 1e9))
+        << " ops/s   p50 " << nanos[nanos.size() / 2]
+        << " ns   p90 " << nanos[nanos.size() * 9 / 10]
+        << " ns   p99 " << nanos[nanos.size() * 99 / 100]
+        << " ns   max " << nanos.back() << " ns\n";
+}
+
+/*
+ * @brief Times each search in a list of keys.
+ *
+ * @param table the table to search
+ * @param keys the keys to look for
+ *
+ * @return the time each search took, in nanoseconds
+ */
+vector<double> timeSearches(Hash& table, const vector<string>& keys) {
+   vector<double> nanos;
+   nanos.reserve(keys.size());
+   for(unsigned int i = 0; i < keys.size(); i++) {
+      Clock::time_point start = Clock::now();
+      table.search(keys[i]);
+      nanos.push_back(std::chrono::duration<double, std::nano>(
+                         Clock::now() - start).count());
+   }
+   return nanos;
+}
+
+/*
+ * @brief Prints how the keys are spread over the containers.
+ *
+ * @param table the loaded table
+ *
+ * Prints a histogram of list lengths and the chi-squared statistic of
+ * the lengths against a uniform spread. Divided by its degrees of
+ * freedom the statistic is about 1 for a uniform hash and grows as
+ * keys pile up in fewer containers. An empty table has no spread to
+ * score, so only that is printed.
+ */
+void printDistribution(Hash& table) {
+   vector<unsigned int> lengths = table.listLengths();
+   double keys = 0;
+   vector<unsigned int> histogram(HISTOGRAM_BUCKETS + 1, 0);
+   for(unsigned int i = 0; i < lengths.size(); i++) {
+      keys += lengths[i];
+      histogram[std::min(lengths[i], HISTOGRAM_BUCKETS)]++;
+   }
+   if(keys == 0) {
+      cout << "   no keys to score\n";
+      return;
+   }
+   double expected = keys / lengths.size();
+   double chiSquared = 0;
+   for(unsigned int i = 0; i < lengths.size(); i++) {
+      chiSquared += (lengths[i] - expected) * (lengths[i] - expected) / expected;
+   }
+   double freedom = lengths.size() - 1;
+   cout << "   list lengths:";
+   for(unsigned int i = 0; i <= HISTOGRAM_BUCKETS; i++) {
+      cout << "  " << i << (i == HISTOGRAM_BUCKETS ? "+" : "") << ":" << histogram[i];
+   }
+   cout << "\n   chi-squared " << chiSquared << " / " << freedom
+        << " = " << chiSquared / freedom
+        << "   (z = " << (chiSquared - freedom) / std::sqrt(2 * freedom) << ")\n";
+}
+
+/*
+ * @brief Runs every measurement on one key set.
+ *
+ * @param name label for the key set
+ * @param keys the keys to insert
+ * @param mode the storage mode to build the table with
+ *
+ * Inserts go through processFile, which is the only way in, so they
+ * are timed INSERT_BATCH keys at a time; each batch's time over its
+ * keys gives one insert latency for the percentiles. Searches are
+ * timed for every key and for every key with a suffix that makes it
+ * miss, then every key is removed.
+ */
+void runSet(const string& name, const vector<string>& keys, Hash::StorageMode mode) {
+   const string fileName = "hashbench.tmp";
+   cout << name << " (" << keys.size() << " keys)\n";
+   Hash* table = new Hash(mode);
+   vector<double> inserts;
+   for(unsigned int first = 0; first < keys.size(); first += INSERT_BATCH) {
+      unsigned int last = std::min(first + INSERT_BATCH, (unsigned int)keys.size());
+      std::ofstream out(fileName);
+      for(unsigned int i = first; i < last; i++) {
+         out << keys[i] << "\n";
+      }
+      out.close();
+      Clock::time_point start = Clock::now();
+      table->processFile(fileName);
+      inserts.push_back(std::chrono::duration<double, std::nano>(
+                           Clock::now() - start).count() / (last - first));
+   }
+   std::remove(fileName.c_str());
+   printTimes("insert", inserts);
+
+   vector<double> hits = timeSearches(*table, keys);
+   printTimes("search hit", hits);
+   vector<string> missing(keys);
+   for(unsigned int i = 0; i < missing.size(); i++) {
+      missing[i] += "#";
+   }
+   vector<double> misses = timeSearches(*table, missing);
+   printTimes("search miss", misses);
+   printDistribution(*table);
+
+   vector<double> removes;
+   removes.reserve(keys.size());
+   for(unsigned int i = 0; i < keys.size(); i++) {
+      Clock::time_point before = Clock::now();
+      table->remove(keys[i]);
+      removes.push_back(std::chrono::duration<double, std::nano>(
+                           Clock::now() - before).count());
+   }
+   printTimes("remove", removes);
+   delete table;
+}
+
+int main(int argc, char** argv) {
+   unsigned int count = 200000;
+   Hash::StorageMode mode = Hash::LIST;
+   for(int i = 1; i < argc; i++) {
+      string arg = argv[i];
+      if(arg == "arena") {
+         mode = Hash::ARENA;
+      } else if(arg == "list") {
+         mode = Hash::LIST;
+      } else if(atoi(argv[i]) > 0) {
+         count = atoi(argv[i]);
+      } else {
+         std::cerr << "usage: " << argv[0] << " [keys] [list|arena]\n";
+         return 1;
+      }
+   }
+   cout << "HASH_TABLE_SIZE = " << HASH_TABLE_SIZE << ", "
+        << (mode == Hash::ARENA ? "arena" : "list") << " storage\n";
+
+   vector<string> dictionary = readWords("/usr/share/dict/words", count);
+   if(!dictionary.empty()) {
+      runSet("dictionary words", dictionary, mode);
+   }
+   runSet("random words", makeWords(count, 311), mode);
+   runSet("urls", makeUrls(count), mode);
+   runSet("sequential ids", makeIds(count), mode);
+   runSet("adversarial collisions", makeCollisions(count), mode);
+   return 0;
+}
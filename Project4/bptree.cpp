@@ -0,0 +1,1014 @@
+/**
+ * @file bptree.cpp A B+-tree storing string keys and values.
+ *
+ * @brief An ordered multimap with the same contract as RBTree: equal
+ * keys are kept in the order they were inserted, rbDelete removes
+ * every entry with a given key and value, and rbFind returns the key
+ * and value of each match. Where RBTree spends one cache miss per
+ * level of a binary tree, each node here holds SLOTS keys, so a tree
+ * of 10^8 entries is six levels deep and a search within a node scans
+ * a packed array of key prefixes.
+ *
+ * Inserts split full nodes on the way down, so a leaf always has room
+ * when it is reached. Deletes fix nodes that fall below their minimum
+ * on the way back up, by redistributing with or merging into a
+ * sibling.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <iterator>
+#include <cmath>
+#include "bptree.h"
+
+using std::cout;
+using std::setw;
+using std::endl;
+
+/*
+ * @brief Default constructor
+ *
+ * The empty tree is a single empty leaf.
+ */
+BPTree::BPTree() {
+   root = new Leaf();
+   entryCount = 0;
+}
+
+/*
+ * @brief Destructor
+ *
+ * Frees every node of the tree.
+ */
+BPTree::~BPTree() {
+   freeTree(root);
+}
+
+/*
+ * @brief Node constructors
+ *
+ * Nodes start out empty; a leaf starts out with no right neighbour.
+ */
+BPTree::Node::Node(bool leaf) : leaf(leaf), count(0) {}
+
+BPTree::Inner::Inner() : Node(false) {}
+
+BPTree::Leaf::Leaf() : Node(true), next(nullptr) {}
+
+/*
+ * @brief Inserts a key and value into the tree
+ *
+ * @param key a reference to the key of the new entry
+ * @param value a reference to the value of the new entry
+ *
+ * @return nothing
+ *
+ * Descends to the last leaf that may hold key, splitting every full
+ * node on the way so the split never has to travel back up, and
+ * counts the new entry in every inner node passed. The new entry goes
+ * after any entries with an equal key.
+ */
+void BPTree::rbInsert(const string& key, const string& value) {
+   uint64_t prefix = keyPrefix(key);
+   if(root->count == SLOTS) {
+      Inner* top = new Inner();
+      top->children[0] = root;
+      top->counts[0] = entryCount;
+      root = top;
+      splitChild(top, 0);
+   }
+   Node* node = root;
+   while(!node->leaf) {
+      Inner* inner = static_cast<Inner*>(node);
+      unsigned int i = upperSlot(inner, key, prefix);
+      if(inner->children[i]->count == SLOTS) {
+         splitChild(inner, i);
+         if(!(key < inner->keys[i])) {
+            i++;
+         }
+      }
+      inner->counts[i]++;
+      node = inner->children[i];
+   }
+   Leaf* leaf = static_cast<Leaf*>(node);
+   unsigned int slot = upperSlot(leaf, key, prefix);
+   for(unsigned int i = leaf->count; i > slot; i--) {
+      moveEntry(leaf, i - 1, leaf, i);
+   }
+   setKey(leaf, slot, key);
+   leaf->values[slot] = value;
+   leaf->count++;
+   entryCount++;
+}
+
+/*
+ * @brief Deletes every entry with a given key and value
+ *
+ * @param key a reference to the key of the entries to delete
+ * @param value a reference to the value of the entries to delete
+ *
+ * @return nothing
+ *
+ * One pass down the tree removes the matches from every leaf that can
+ * hold key, rebalancing on the way back up, so deleting among many
+ * duplicates costs O(log n) plus the leaves holding key. The root is
+ * dropped while merges leave it with a single child.
+ */
+void BPTree::rbDelete(const string& key, const string& value) {
+   entryCount -= eraseFrom(root, key, value, keyPrefix(key));
+   while(!root->leaf && root->count == 0) {
+      Inner* old = static_cast<Inner*>(root);
+      root = old->children[0];
+      delete old;
+   }
+}
+
+/*
+ * @brief Finds the entries with a key
+ *
+ * @param key a reference to the key to search for
+ *
+ * @return the key and value of each match, one after the other, in
+ * insertion order
+ */
+vector<const string*> BPTree::rbFind(const string& key) {
+   vector<const string*> found;
+   for(Iterator it = lowerBound(key); it != end() && it.key() == key; ++it) {
+      found.push_back(&it.key());
+      found.push_back(&it.value());
+   }
+   return found;
+}
+
+/*
+ * @brief Prints the tree sideways
+ *
+ * @return nothing
+ *
+ * Like RBTree::rbPrintTree the largest keys come first and each level
+ * is indented four more columns. Separators of inner nodes are marked
+ * I and entries of leaves L.
+ */
+void BPTree::rbPrintTree() {
+   printNode(root, 0);
+}
+
+/*
+ * @brief Inserts a batch of entries
+ *
+ * @param entries a reference to the (key, value) pairs to insert;
+ * sorted by key in place if they are not already
+ *
+ * @return nothing
+ *
+ * Works like RBTree::rbBulkLoad: a batch too small to be worth it is
+ * inserted entry by entry, otherwise the existing entries are merged
+ * with the batch and the tree is rebuilt bottom-up in O(n + m), with
+ * entries of equal keys after the ones already in the tree.
+ */
+void BPTree::rbBulkLoad(vector<pair<string, string> >& entries) {
+   if(entries.empty()) {
+      return;
+   }
+   if(!std::is_sorted(entries.begin(), entries.end(),
+         [ ](const pair<string, string>& lhs, const pair<string, string>& rhs) {
+            return lhs.first < rhs.first;
+         })) {
+      std::stable_sort(entries.begin(), entries.end(),
+         [ ](const pair<string, string>& lhs, const pair<string, string>& rhs) {
+            return lhs.first < rhs.first;
+         });
+   }
+   unsigned int existing = entryCount;
+   if(existing > 0 && entries.size() * std::log2(existing + 1.0) < existing) {
+      for(vector<pair<string, string> >::iterator it = entries.begin();
+            it != entries.end(); ++it) {
+         rbInsert(it->first, it->second);
+      }
+      return;
+   }
+
+   vector<pair<string, string> > old;
+   old.reserve(existing);
+   Node* node = root;
+   while(!node->leaf) {
+      node = static_cast<Inner*>(node)->children[0];
+   }
+   for(Leaf* leaf = static_cast<Leaf*>(node); leaf != nullptr; leaf = leaf->next) {
+      for(unsigned int i = 0; i < leaf->count; i++) {
+         old.push_back(std::make_pair(std::move(leaf->keys[i]),
+                                      std::move(leaf->values[i])));
+      }
+   }
+   vector<pair<string, string> > merged(old.size() + entries.size());
+   std::merge(std::make_move_iterator(old.begin()), std::make_move_iterator(old.end()),
+      entries.begin(), entries.end(), merged.begin(),
+      [ ](const pair<string, string>& lhs, const pair<string, string>& rhs) {
+         return lhs.first < rhs.first;
+      });
+   freeTree(root);
+   build(merged);
+}
+
+/*
+ * @brief Iterator constructor
+ *
+ * @param leaf a pointer to the leaf holding the entry, or nullptr for
+ * the end
+ * @param slot the index of the entry in its leaf
+ */
+BPTree::Iterator::Iterator(Leaf* leaf, unsigned int slot)
+   : leaf(leaf), slot(slot) {}
+
+/*
+ * @brief Gets the key of the current entry
+ *
+ * @return a reference to the key
+ */
+const string& BPTree::Iterator::key() const {
+   return leaf->keys[slot];
+}
+
+/*
+ * @brief Gets the value of the current entry
+ *
+ * @return a reference to the value
+ */
+const string& BPTree::Iterator::value() const {
+   return leaf->values[slot];
+}
+
+/*
+ * @brief Moves to the next entry in key order
+ *
+ * @return a reference to this iterator
+ */
+BPTree::Iterator& BPTree::Iterator::operator++() {
+   slot++;
+   if(slot == leaf->count) {
+      leaf = leaf->next;
+      slot = 0;
+   }
+   return *this;
+}
+
+/*
+ * @brief Compares two iterators
+ *
+ * @param other a reference to the iterator to compare with
+ *
+ * @return true if both are at the same entry
+ */
+bool BPTree::Iterator::operator==(const Iterator& other) const {
+   return leaf == other.leaf && slot == other.slot;
+}
+
+/*
+ * @brief Compares two iterators
+ *
+ * @param other a reference to the iterator to compare with
+ *
+ * @return true if they are at different entries
+ */
+bool BPTree::Iterator::operator!=(const Iterator& other) const {
+   return !(*this == other);
+}
+
+/*
+ * @brief Gets an iterator at the smallest entry
+ *
+ * @return the iterator, or end() if the tree is empty
+ */
+BPTree::Iterator BPTree::begin() {
+   Node* node = root;
+   while(!node->leaf) {
+      node = static_cast<Inner*>(node)->children[0];
+   }
+   return position(static_cast<Leaf*>(node), 0);
+}
+
+/*
+ * @brief Gets the iterator one past the largest entry
+ *
+ * @return the end iterator
+ */
+BPTree::Iterator BPTree::end() {
+   return Iterator(nullptr, 0);
+}
+
+/*
+ * @brief Finds the first entry whose key is not less than a key
+ *
+ * @param key a reference to the key to search for
+ *
+ * @return an iterator at the entry, or end() if there is none
+ *
+ * Follows the children left of every separator >= key, which leads
+ * to the leftmost leaf that may hold key.
+ */
+BPTree::Iterator BPTree::lowerBound(const string& key) {
+   uint64_t prefix = keyPrefix(key);
+   Node* node = root;
+   while(!node->leaf) {
+      node = static_cast<Inner*>(node)->children[lowerSlot(node, key, prefix)];
+   }
+   return position(static_cast<Leaf*>(node), lowerSlot(node, key, prefix));
+}
+
+/*
+ * @brief Finds the first entry whose key is greater than a key
+ *
+ * @param key a reference to the key to search for
+ *
+ * @return an iterator at the entry, or end() if there is none
+ */
+BPTree::Iterator BPTree::upperBound(const string& key) {
+   uint64_t prefix = keyPrefix(key);
+   Node* node = root;
+   while(!node->leaf) {
+      node = static_cast<Inner*>(node)->children[upperSlot(node, key, prefix)];
+   }
+   return position(static_cast<Leaf*>(node), upperSlot(node, key, prefix));
+}
+
+/*
+ * @brief Gets the entries with keys in a half-open interval
+ *
+ * @param lo a reference to the smallest key in the interval
+ * @param hi a reference to the first key past the interval
+ *
+ * @return the range of entries with lo <= key < hi, in order; empty
+ * if hi <= lo
+ */
+BPTree::Range BPTree::rbRange(const string& lo, const string& hi) {
+   if(!(lo < hi)) {
+      return Range(end(), end());
+   }
+   return Range(lowerBound(lo), lowerBound(hi));
+}
+
+/*
+ * @brief Gets the entries whose keys begin with a prefix
+ *
+ * @param prefix a reference to the string every key must start with
+ *
+ * @return the range of matching entries, in order
+ *
+ * Bounds the range the same way as RBTree::rbPrefix.
+ */
+BPTree::Range BPTree::rbPrefix(const string& prefix) {
+   string limit = prefix;
+   while(!limit.empty() && (unsigned char)limit.back() == 0xFF) {
+      limit.pop_back();
+   }
+   if(limit.empty()) {
+      return Range(lowerBound(prefix), end());
+   }
+   limit.back() = (char)((unsigned char)limit.back() + 1);
+   return Range(lowerBound(prefix), lowerBound(limit));
+}
+
+/*
+ * @brief Counts the entries whose keys are less than a key
+ *
+ * @param key a reference to the key to compare against
+ *
+ * @return the number of entries with a smaller key
+ *
+ * Follows the same path as lowerBound, adding up the counts of the
+ * children passed over on the left.
+ */
+unsigned int BPTree::rank(const string& key) {
+   uint64_t prefix = keyPrefix(key);
+   unsigned int smaller = 0;
+   Node* node = root;
+   while(!node->leaf) {
+      Inner* inner = static_cast<Inner*>(node);
+      unsigned int i = lowerSlot(inner, key, prefix);
+      for(unsigned int j = 0; j < i; j++) {
+         smaller += inner->counts[j];
+      }
+      node = inner->children[i];
+   }
+   return smaller + lowerSlot(node, key, prefix);
+}
+
+/*
+ * @brief Finds the entry at a position in key order
+ *
+ * @param i the position, counting from 0
+ *
+ * @return an iterator at the entry, or end() if the tree has no more
+ * than i entries
+ */
+BPTree::Iterator BPTree::select(unsigned int i) {
+   if(i >= entryCount) {
+      return end();
+   }
+   Node* node = root;
+   while(!node->leaf) {
+      Inner* inner = static_cast<Inner*>(node);
+      unsigned int j = 0;
+      while(i >= inner->counts[j]) {
+         i -= inner->counts[j];
+         j++;
+      }
+      node = inner->children[j];
+   }
+   return Iterator(static_cast<Leaf*>(node), i);
+}
+
+/*
+ * @brief Counts the entries with keys in a half-open interval
+ *
+ * @param lo a reference to the smallest key to count
+ * @param hi a reference to the first key past the interval
+ *
+ * @return the number of entries with lo <= key < hi; 0 if hi <= lo
+ */
+unsigned int BPTree::countRange(const string& lo, const string& hi) {
+   if(!(lo < hi)) {
+      return 0;
+   }
+   return rank(hi) - rank(lo);
+}
+
+/*
+ * @brief Range constructor
+ *
+ * @param first an iterator at the first entry of the range
+ * @param last an iterator one past the last entry of the range
+ */
+BPTree::Range::Range(const Iterator& first, const Iterator& last)
+   : first(first), last(last) {}
+
+/*
+ * @brief Gets the start of the range
+ *
+ * @return an iterator at the first entry
+ */
+BPTree::Iterator BPTree::Range::begin() const {
+   return first;
+}
+
+/*
+ * @brief Gets the end of the range
+ *
+ * @return an iterator one past the last entry
+ */
+BPTree::Iterator BPTree::Range::end() const {
+   return last;
+}
+
+/*
+ * @brief Packs the first 8 bytes of a key into an integer
+ *
+ * @param key a reference to the key
+ *
+ * @return the bytes big-endian, padded with zeros
+ *
+ * Comparing prefixes gives the same order as comparing the keys
+ * whenever the prefixes differ.
+ */
+uint64_t BPTree::keyPrefix(const string& key) {
+   uint64_t prefix = 0;
+   for(unsigned int i = 0; i < 8; i++) {
+      prefix <<= 8;
+      if(i < key.size()) {
+         prefix |= (unsigned char)key[i];
+      }
+   }
+   return prefix;
+}
+
+/*
+ * @brief Finds the first key of a node that is not less than a key
+ *
+ * @param node a pointer to the node to search
+ * @param key a reference to the key to search for
+ * @param prefix the keyPrefix of key
+ *
+ * @return the slot of that key, or node->count if there is none
+ */
+unsigned int BPTree::lowerSlot(const Node* node, const string& key, uint64_t prefix) {
+   unsigned int lo = 0;
+   unsigned int hi = node->count;
+   while(lo < hi) {
+      unsigned int mid = (lo + hi) / 2;
+      if(node->prefix[mid] < prefix ||
+            (node->prefix[mid] == prefix && node->keys[mid] < key)) {
+         lo = mid + 1;
+      } else {
+         hi = mid;
+      }
+   }
+   return lo;
+}
+
+/*
+ * @brief Finds the first key of a node that is greater than a key
+ *
+ * @param node a pointer to the node to search
+ * @param key a reference to the key to search for
+ * @param prefix the keyPrefix of key
+ *
+ * @return the slot of that key, or node->count if there is none
+ */
+unsigned int BPTree::upperSlot(const Node* node, const string& key, uint64_t prefix) {
+   unsigned int lo = 0;
+   unsigned int hi = node->count;
+   while(lo < hi) {
+      unsigned int mid = (lo + hi) / 2;
+      if(node->prefix[mid] < prefix ||
+            (node->prefix[mid] == prefix && !(key < node->keys[mid]))) {
+         lo = mid + 1;
+      } else {
+         hi = mid;
+      }
+   }
+   return lo;
+}
+
+/*
+ * @brief Stores a key and its prefix in a slot of a node
+ *
+ * @param node a pointer to the node
+ * @param slot the slot to overwrite
+ * @param key a reference to the key to copy in
+ *
+ * @return nothing
+ */
+void BPTree::setKey(Node* node, unsigned int slot, const string& key) {
+   node->prefix[slot] = keyPrefix(key);
+   node->keys[slot] = key;
+}
+
+/*
+ * @brief Moves an entry from one leaf slot to another
+ *
+ * @param from a pointer to the leaf to take the entry from
+ * @param i the slot to take it from, left empty
+ * @param to a pointer to the leaf to put it in
+ * @param j the slot to put it in
+ *
+ * @return nothing
+ */
+void BPTree::moveEntry(Leaf* from, unsigned int i, Leaf* to, unsigned int j) {
+   to->prefix[j] = from->prefix[i];
+   to->keys[j] = std::move(from->keys[i]);
+   to->values[j] = std::move(from->values[i]);
+}
+
+/*
+ * @brief Moves a key from one node slot to another
+ *
+ * @param from a pointer to the node to take the key from
+ * @param i the slot to take it from, left empty
+ * @param to a pointer to the node to put it in
+ * @param j the slot to put it in
+ *
+ * @return nothing
+ */
+void BPTree::moveKey(Node* from, unsigned int i, Node* to, unsigned int j) {
+   to->prefix[j] = from->prefix[i];
+   to->keys[j] = std::move(from->keys[i]);
+}
+
+/*
+ * @brief Makes an iterator, stepping past the end of a leaf
+ *
+ * @param leaf a pointer to a leaf
+ * @param slot an index in the leaf, at most leaf->count
+ *
+ * @return an iterator at the entry, or at the first entry of the next
+ * leaf if slot is past the last one
+ */
+BPTree::Iterator BPTree::position(Leaf* leaf, unsigned int slot) {
+   if(slot == leaf->count) {
+      return Iterator(leaf->next, 0);
+   }
+   return Iterator(leaf, slot);
+}
+
+/*
+ * @brief Splits a full child in two
+ *
+ * @param parent a pointer to an inner node with room for one more key
+ * @param i the index of the full child
+ *
+ * @return nothing
+ *
+ * A leaf is cut in half and the first key of the right half is copied
+ * up as the separator. An inner node gives its middle key to the
+ * parent and its upper keys and children to the new node.
+ */
+void BPTree::splitChild(Inner* parent, unsigned int i) {
+   Node* child = parent->children[i];
+   Node* right;
+   unsigned int rightCount = 0;
+   string separator;
+   if(child->leaf) {
+      Leaf* left = static_cast<Leaf*>(child);
+      Leaf* newLeaf = new Leaf();
+      for(unsigned int j = MIN_LEAF; j < SLOTS; j++) {
+         moveEntry(left, j, newLeaf, j - MIN_LEAF);
+      }
+      left->count = MIN_LEAF;
+      newLeaf->count = SLOTS - MIN_LEAF;
+      newLeaf->next = left->next;
+      left->next = newLeaf;
+      separator = newLeaf->keys[0];
+      rightCount = newLeaf->count;
+      right = newLeaf;
+   } else {
+      Inner* left = static_cast<Inner*>(child);
+      Inner* newInner = new Inner();
+      unsigned int middle = SLOTS / 2;
+      for(unsigned int j = middle + 1; j < SLOTS; j++) {
+         moveKey(left, j, newInner, j - middle - 1);
+      }
+      for(unsigned int j = middle + 1; j <= SLOTS; j++) {
+         newInner->children[j - middle - 1] = left->children[j];
+         newInner->counts[j - middle - 1] = left->counts[j];
+         rightCount += left->counts[j];
+      }
+      separator = std::move(left->keys[middle]);
+      left->count = middle;
+      newInner->count = SLOTS - middle - 1;
+      right = newInner;
+   }
+   for(unsigned int j = parent->count; j > i; j--) {
+      moveKey(parent, j - 1, parent, j);
+      parent->children[j + 1] = parent->children[j];
+      parent->counts[j + 1] = parent->counts[j];
+   }
+   parent->prefix[i] = keyPrefix(separator);
+   parent->keys[i] = std::move(separator);
+   parent->children[i + 1] = right;
+   parent->counts[i + 1] = rightCount;
+   parent->counts[i] -= rightCount;
+   parent->count++;
+}
+
+/*
+ * @brief Removes the matching entries below a node
+ *
+ * @param node a pointer to the root of the subtree to search
+ * @param key a reference to the key of the entries to delete
+ * @param value a reference to the value of the entries to delete
+ * @param prefix the keyPrefix of key
+ *
+ * @return how many entries were removed; 0 if the subtree has none
+ *
+ * Every child whose key range can hold key is searched. Afterwards
+ * the children removed from are brought back up to their minimum
+ * size, right to left so the merges do not move the ones still to
+ * fix.
+ */
+unsigned int BPTree::eraseFrom(Node* node, const string& key,
+                               const string& value, uint64_t prefix) {
+   if(!node->leaf) {
+      Inner* inner = static_cast<Inner*>(node);
+      unsigned int first = lowerSlot(inner, key, prefix);
+      unsigned int last = upperSlot(inner, key, prefix);
+      unsigned int removed = 0;
+      for(unsigned int i = first; i <= last; i++) {
+         unsigned int fromChild = eraseFrom(inner->children[i], key, value, prefix);
+         inner->counts[i] -= fromChild;
+         removed += fromChild;
+      }
+      if(removed > 0) {
+         for(unsigned int i = last + 1; i-- > first; ) {
+            if(i <= inner->count) {
+               fixChild(inner, i);
+            }
+         }
+      }
+      return removed;
+   }
+
+   Leaf* leaf = static_cast<Leaf*>(node);
+   unsigned int i = lowerSlot(leaf, key, prefix);
+   unsigned int kept = i;
+   for(; i < leaf->count && leaf->keys[i] == key; i++) {
+      if(leaf->values[i] != value) {
+         if(kept != i) {
+            moveEntry(leaf, i, leaf, kept);
+         }
+         kept++;
+      }
+   }
+   unsigned int removed = i - kept;
+   if(removed > 0) {
+      for(; i < leaf->count; i++) {
+         moveEntry(leaf, i, leaf, i - removed);
+      }
+      leaf->count -= removed;
+      for(i = leaf->count; i < leaf->count + removed; i++) {
+         string().swap(leaf->keys[i]);
+         string().swap(leaf->values[i]);
+      }
+   }
+   return removed;
+}
+
+/*
+ * @brief Brings a child that may be too small back to its minimum
+ *
+ * @param parent a pointer to an inner node with at least one key
+ * @param i the index of the child
+ *
+ * @return nothing
+ *
+ * The child is paired with its left sibling, or its right one if it
+ * has none. If the two fit in one node they are merged; otherwise
+ * leaves share their entries evenly and an inner node takes keys
+ * through the parent one at a time. A child that a delete emptied
+ * far below its minimum can still be short after a merge, so this
+ * repeats until it is not or it is the parent's only child.
+ */
+void BPTree::fixChild(Inner* parent, unsigned int i) {
+   while(parent->count > 0) {
+      Node* child = parent->children[i];
+      unsigned int minimum = child->leaf ? MIN_LEAF : MIN_INNER;
+      if(child->count >= minimum) {
+         return;
+      }
+      unsigned int left = (i > 0) ? i - 1 : i;
+      unsigned int together = parent->children[left]->count +
+                              parent->children[left + 1]->count;
+      if(child->leaf) {
+         if(together <= SLOTS) {
+            mergeChildren(parent, left);
+            i = left;
+         } else {
+            balanceLeaves(parent, left);
+            return;
+         }
+      } else {
+         if(together + 1 <= SLOTS) {
+            mergeChildren(parent, left);
+            i = left;
+         } else {
+            rotateInner(parent, left, left == i);
+         }
+      }
+   }
+}
+
+/*
+ * @brief Evens out the entries of two neighbouring leaves
+ *
+ * @param parent a pointer to the parent of both leaves
+ * @param left the index of the left leaf
+ *
+ * @return nothing
+ */
+void BPTree::balanceLeaves(Inner* parent, unsigned int left) {
+   Leaf* a = static_cast<Leaf*>(parent->children[left]);
+   Leaf* b = static_cast<Leaf*>(parent->children[left + 1]);
+   unsigned int target = (a->count + b->count) / 2;
+   if(a->count > target) {
+      unsigned int moving = a->count - target;
+      for(unsigned int j = b->count; j > 0; j--) {
+         moveEntry(b, j - 1, b, j - 1 + moving);
+      }
+      for(unsigned int j = 0; j < moving; j++) {
+         moveEntry(a, target + j, b, j);
+      }
+      a->count = target;
+      b->count += moving;
+   } else {
+      unsigned int moving = target - a->count;
+      for(unsigned int j = 0; j < moving; j++) {
+         moveEntry(b, j, a, a->count + j);
+      }
+      for(unsigned int j = moving; j < b->count; j++) {
+         moveEntry(b, j, b, j - moving);
+      }
+      a->count = target;
+      b->count -= moving;
+   }
+   setKey(parent, left, b->keys[0]);
+   parent->counts[left] = a->count;
+   parent->counts[left + 1] = b->count;
+}
+
+/*
+ * @brief Merges a child into its left neighbour
+ *
+ * @param parent a pointer to the parent of both children
+ * @param left the index of the left child; the one after it is freed
+ *
+ * @return nothing
+ *
+ * Inner nodes take the parent's separator between their keys.
+ */
+void BPTree::mergeChildren(Inner* parent, unsigned int left) {
+   Node* a = parent->children[left];
+   Node* b = parent->children[left + 1];
+   if(a->leaf) {
+      Leaf* leafA = static_cast<Leaf*>(a);
+      Leaf* leafB = static_cast<Leaf*>(b);
+      for(unsigned int j = 0; j < leafB->count; j++) {
+         moveEntry(leafB, j, leafA, leafA->count + j);
+      }
+      leafA->count += leafB->count;
+      leafA->next = leafB->next;
+      delete leafB;
+   } else {
+      Inner* innerA = static_cast<Inner*>(a);
+      Inner* innerB = static_cast<Inner*>(b);
+      moveKey(parent, left, innerA, innerA->count);
+      for(unsigned int j = 0; j < innerB->count; j++) {
+         moveKey(innerB, j, innerA, innerA->count + 1 + j);
+      }
+      for(unsigned int j = 0; j <= innerB->count; j++) {
+         innerA->children[innerA->count + 1 + j] = innerB->children[j];
+         innerA->counts[innerA->count + 1 + j] = innerB->counts[j];
+      }
+      innerA->count += 1 + innerB->count;
+      delete innerB;
+   }
+   parent->counts[left] += parent->counts[left + 1];
+   for(unsigned int j = left + 1; j < parent->count; j++) {
+      moveKey(parent, j, parent, j - 1);
+      parent->children[j] = parent->children[j + 1];
+      parent->counts[j] = parent->counts[j + 1];
+   }
+   parent->count--;
+   string().swap(parent->keys[parent->count]);
+}
+
+/*
+ * @brief Moves one key between neighbouring inner nodes
+ *
+ * @param parent a pointer to the parent of both nodes
+ * @param left the index of the left node
+ * @param fromRight true to give the left node the right one's first
+ * child, false to give the right node the left one's last child
+ *
+ * @return nothing
+ *
+ * The separator in the parent comes down into the receiving node and
+ * the giving node's end key goes up to replace it.
+ */
+void BPTree::rotateInner(Inner* parent, unsigned int left, bool fromRight) {
+   Inner* a = static_cast<Inner*>(parent->children[left]);
+   Inner* b = static_cast<Inner*>(parent->children[left + 1]);
+   unsigned int moved;
+   if(fromRight) {
+      moved = b->counts[0];
+      moveKey(parent, left, a, a->count);
+      a->children[a->count + 1] = b->children[0];
+      a->counts[a->count + 1] = moved;
+      a->count++;
+      moveKey(b, 0, parent, left);
+      for(unsigned int j = 1; j < b->count; j++) {
+         moveKey(b, j, b, j - 1);
+      }
+      for(unsigned int j = 1; j <= b->count; j++) {
+         b->children[j - 1] = b->children[j];
+         b->counts[j - 1] = b->counts[j];
+      }
+      b->count--;
+      parent->counts[left] += moved;
+      parent->counts[left + 1] -= moved;
+   } else {
+      moved = a->counts[a->count];
+      for(unsigned int j = b->count; j > 0; j--) {
+         moveKey(b, j - 1, b, j);
+      }
+      for(unsigned int j = b->count + 1; j > 0; j--) {
+         b->children[j] = b->children[j - 1];
+         b->counts[j] = b->counts[j - 1];
+      }
+      moveKey(parent, left, b, 0);
+      b->children[0] = a->children[a->count];
+      b->counts[0] = moved;
+      b->count++;
+      moveKey(a, a->count - 1, parent, left);
+      a->count--;
+      parent->counts[left] -= moved;
+      parent->counts[left + 1] += moved;
+   }
+}
+
+/*
+ * @brief Builds the tree bottom-up from sorted entries
+ *
+ * @param entries a reference to the entries in key order; their
+ * strings are moved into the tree
+ *
+ * @return nothing
+ *
+ * The entries are spread evenly over as few leaves as will hold them,
+ * and each level of inner nodes is made the same way from the one
+ * below, so every node is at least half full.
+ */
+void BPTree::build(vector<pair<string, string> >& entries) {
+   unsigned int n = entries.size();
+   entryCount = n;
+   if(n == 0) {
+      root = new Leaf();
+      return;
+   }
+   vector<Node*> level;
+   vector<unsigned int> sizes;       // entries below each node
+   vector<string> lows;              // smallest key below each node
+   unsigned int leaves = (n + SLOTS - 1) / SLOTS;
+   unsigned int next = 0;
+   Leaf* previous = nullptr;
+   for(unsigned int l = 0; l < leaves; l++) {
+      Leaf* leaf = new Leaf();
+      leaf->count = n / leaves + (l < n % leaves ? 1 : 0);
+      for(unsigned int j = 0; j < leaf->count; j++, next++) {
+         leaf->prefix[j] = keyPrefix(entries[next].first);
+         leaf->keys[j] = std::move(entries[next].first);
+         leaf->values[j] = std::move(entries[next].second);
+      }
+      if(previous != nullptr) {
+         previous->next = leaf;
+      }
+      previous = leaf;
+      level.push_back(leaf);
+      sizes.push_back(leaf->count);
+      lows.push_back(leaf->keys[0]);
+   }
+   while(level.size() > 1) {
+      unsigned int m = level.size();
+      unsigned int parents = (m + SLOTS) / (SLOTS + 1);
+      vector<Node*> upper;
+      vector<unsigned int> upperSizes;
+      vector<string> upperLows;
+      unsigned int c = 0;
+      for(unsigned int p = 0; p < parents; p++) {
+         Inner* inner = new Inner();
+         unsigned int children = m / parents + (p < m % parents ? 1 : 0);
+         unsigned int total = 0;
+         upperLows.push_back(std::move(lows[c]));
+         for(unsigned int j = 0; j < children; j++, c++) {
+            if(j > 0) {
+               inner->prefix[j - 1] = keyPrefix(lows[c]);
+               inner->keys[j - 1] = std::move(lows[c]);
+            }
+            inner->children[j] = level[c];
+            inner->counts[j] = sizes[c];
+            total += sizes[c];
+         }
+         inner->count = children - 1;
+         upper.push_back(inner);
+         upperSizes.push_back(total);
+      }
+      level.swap(upper);
+      sizes.swap(upperSizes);
+      lows.swap(upperLows);
+   }
+   root = level[0];
+}
+
+/*
+ * @brief Frees a subtree
+ *
+ * @param node a pointer to the root of the subtree
+ *
+ * @return nothing
+ */
+void BPTree::freeTree(Node* node) {
+   if(node->leaf) {
+      delete static_cast<Leaf*>(node);
+      return;
+   }
+   Inner* inner = static_cast<Inner*>(node);
+   for(unsigned int i = 0; i <= inner->count; i++) {
+      freeTree(inner->children[i]);
+   }
+   delete inner;
+}
+
+/*
+ * @brief Prints a subtree sideways, largest keys first
+ *
+ * @param node a pointer to the root of the subtree
+ * @param depth the level of node, 0 for the root
+ *
+ * @return nothing
+ */
+void BPTree::printNode(Node* node, int depth) {
+   if(node->leaf) {
+      Leaf* leaf = static_cast<Leaf*>(node);
+      for(unsigned int i = leaf->count; i > 0; i--) {
+         cout << setw(depth*4+4) << 'L' << " ";
+         cout << leaf->keys[i - 1] << " " << leaf->values[i - 1] << endl;
+      }
+      return;
+   }
+   Inner* inner = static_cast<Inner*>(node);
+   for(unsigned int i = inner->count + 1; i > 0; i--) {
+      printNode(inner->children[i - 1], depth+1);
+      if(i > 1) {
+         cout << setw(depth*4+4) << 'I' << " " << inner->keys[i - 2] << endl;
+      }
+   }
+}
@@ -0,0 +1,143 @@
+/**
+ * @file bptree.h Declaration of a B+-tree with the same interface as
+ * RBTree.
+ *
+ * Note: like RBTree, the functions in this class do no I/O except
+ * rbPrintTree.
+ */
+
+#ifndef CSCI_311_BPTREE_H
+#define CSCI_311_BPTREE_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+using std::string;
+using std::vector;
+using std::pair;
+
+class BPTree {
+
+public:
+
+   BPTree();
+   ~BPTree();
+   BPTree(const BPTree&) = delete;
+   BPTree& operator=(const BPTree&) = delete;
+
+   void rbInsert(const string& key, const string& value);
+   void rbDelete(const string& key, const string& value);
+   vector<const string*> rbFind(const string& key);
+   void rbPrintTree();
+
+private:
+
+   // keys per node; a node's prefixes fill four cache lines
+   static const unsigned int SLOTS = 32;
+   // fewest entries a leaf other than the root keeps after a delete
+   static const unsigned int MIN_LEAF = SLOTS / 2;
+   // fewest keys an inner node other than the root keeps
+   static const unsigned int MIN_INNER = (SLOTS - 1) / 2;
+
+   // The first 8 bytes of each key, big-endian and zero padded, sit in
+   // one array so a search within a node compares integers and only
+   // touches a key's string when two prefixes tie.
+   class Node {
+   public:
+      Node(bool);
+      bool leaf;
+      unsigned int count;          // keys in use
+      uint64_t prefix[SLOTS];
+      string keys[SLOTS];
+   };
+
+   // Inner node: children[i] holds keys <= keys[i] <= keys in
+   // children[i + 1], and counts[i] entries.
+   class Inner : public Node {
+   public:
+      Inner();
+      Node *children[SLOTS + 1];
+      unsigned int counts[SLOTS + 1];
+   };
+
+   // Leaf node: entries sorted by key, equal keys in insertion order,
+   // chained left to right for scans.
+   class Leaf : public Node {
+   public:
+      Leaf();
+      string values[SLOTS];
+      Leaf *next;
+   };
+
+   Node *root;                  // a leaf while the tree is small
+   unsigned int entryCount;     // entries currently in the tree
+
+public:
+
+   // In-order iterator over the entries of the tree, like
+   // RBTree::Iterator. Any rbInsert or rbDelete invalidates it.
+   class Iterator {
+   public:
+      const string& key() const;
+      const string& value() const;
+      Iterator& operator++();
+      bool operator==(const Iterator&) const;
+      bool operator!=(const Iterator&) const;
+   private:
+      friend class BPTree;
+      Iterator(Leaf*, unsigned int);
+      Leaf *leaf;
+      unsigned int slot;
+   };
+
+   Iterator begin();                         // smallest entry
+   Iterator end();                           // one past the largest entry
+   Iterator lowerBound(const string& key);   // first entry with key >= key
+   Iterator upperBound(const string& key);   // first entry with key > key
+
+   // Half-open run of entries [first, last) in key order.
+   class Range {
+   public:
+      Range(const Iterator& first, const Iterator& last);
+      Iterator begin() const;
+      Iterator end() const;
+   private:
+      Iterator first;
+      Iterator last;
+   };
+
+   Range rbRange(const string& lo, const string& hi);   // lo <= key < hi
+   Range rbPrefix(const string& prefix);     // keys starting with prefix
+
+   // insert a batch of (key, value) pairs; sorts the batch by key
+   void rbBulkLoad(vector<pair<string, string> >& entries);
+
+   // order statistics, O(log n) from the entry counts of the children
+   unsigned int rank(const string& key);     // entries with key < key
+   Iterator select(unsigned int i);          // i-th entry from 0, or end()
+   unsigned int countRange(const string& lo, const string& hi);   // lo <= key < hi
+
+private:
+
+   static uint64_t keyPrefix(const string&);
+   static unsigned int lowerSlot(const Node*, const string&, uint64_t);
+   static unsigned int upperSlot(const Node*, const string&, uint64_t);
+   static void setKey(Node*, unsigned int, const string&);
+   static void moveEntry(Leaf*, unsigned int, Leaf*, unsigned int);
+   static void moveKey(Node*, unsigned int, Node*, unsigned int);
+
+   Iterator position(Leaf*, unsigned int);
+   void splitChild(Inner*, unsigned int);
+   unsigned int eraseFrom(Node*, const string&, const string&, uint64_t);
+   void fixChild(Inner*, unsigned int);
+   void balanceLeaves(Inner*, unsigned int);
+   void mergeChildren(Inner*, unsigned int);
+   void rotateInner(Inner*, unsigned int, bool);
+   void build(vector<pair<string, string> >&);
+   void freeTree(Node*);
+   void printNode(Node*, int);
+};
+
+#endif // CSCI_311_BPTREE_H
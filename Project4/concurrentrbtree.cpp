@@ -0,0 +1,106 @@
+/**
+ * @file concurrentrbtree.cpp A red-black tree that many threads can
+ * read while one thread at a time writes.
+ *
+ * @brief Wraps an RBTree in a reader-writer lock. Finds and scans
+ * take the lock shared, so any number of them run in parallel;
+ * inserts, deletes and bulk loads take it exclusively. RBTree's
+ * lookups never modify the tree, which is what makes sharing safe.
+ */
+
+#include <mutex>
+#include "concurrentrbtree.h"
+
+/*
+ * @brief Inserts an entry while holding the lock exclusively
+ *
+ * @param key a reference to the key of the new entry
+ * @param value a reference to the value of the new entry
+ *
+ * @return nothing
+ */
+void ConcurrentRBTree::rbInsert(const string& key, const string& value) {
+   std::unique_lock<std::shared_timed_mutex> writing(treeLock);
+   tree.rbInsert(key, value);
+}
+
+/*
+ * @brief Deletes matching entries while holding the lock exclusively
+ *
+ * @param key a reference to the key of the entries to delete
+ * @param value a reference to the value of the entries to delete
+ *
+ * @return nothing
+ */
+void ConcurrentRBTree::rbDelete(const string& key, const string& value) {
+   std::unique_lock<std::shared_timed_mutex> writing(treeLock);
+   tree.rbDelete(key, value);
+}
+
+/*
+ * @brief Bulk loads a batch while holding the lock exclusively
+ *
+ * @param entries a reference to the (key, value) pairs to insert;
+ * sorted by key as a side effect
+ *
+ * @return nothing
+ */
+void ConcurrentRBTree::rbBulkLoad(vector<pair<string, string> >& entries) {
+   std::unique_lock<std::shared_timed_mutex> writing(treeLock);
+   tree.rbBulkLoad(entries);
+}
+
+/*
+ * @brief Finds every entry with a key while sharing the lock
+ *
+ * @param key a reference to the key to look for
+ *
+ * @return copies of the matching (key, value) pairs in insertion order
+ */
+vector<pair<string, string> > ConcurrentRBTree::rbFind(const string& key) {
+   std::shared_lock<std::shared_timed_mutex> reading(treeLock);
+   return copyRange(RBTree::Range(tree.lowerBound(key), tree.upperBound(key)));
+}
+
+/*
+ * @brief Collects the entries in [lo, hi) while sharing the lock
+ *
+ * @param lo a reference to the smallest key to include
+ * @param hi a reference to the first key past the interval
+ *
+ * @return copies of the entries in key order
+ */
+vector<pair<string, string> > ConcurrentRBTree::rbRange(const string& lo,
+                                                        const string& hi) {
+   std::shared_lock<std::shared_timed_mutex> reading(treeLock);
+   return copyRange(tree.rbRange(lo, hi));
+}
+
+/*
+ * @brief Collects the entries whose keys start with a prefix while
+ * sharing the lock
+ *
+ * @param prefix a reference to the string every key must start with
+ *
+ * @return copies of the entries in key order
+ */
+vector<pair<string, string> > ConcurrentRBTree::rbPrefix(const string& prefix) {
+   std::shared_lock<std::shared_timed_mutex> reading(treeLock);
+   return copyRange(tree.rbPrefix(prefix));
+}
+
+/*
+ * @brief Copies the entries of a range out of the tree
+ *
+ * @param range a reference to the range to copy; the caller must
+ * hold the lock
+ *
+ * @return the (key, value) pairs of the range
+ */
+vector<pair<string, string> > ConcurrentRBTree::copyRange(const RBTree::Range& range) {
+   vector<pair<string, string> > entries;
+   for(RBTree::Iterator it = range.begin(); it != range.end(); ++it) {
+      entries.push_back(std::make_pair(it.key(), it.value()));
+   }
+   return entries;
+}
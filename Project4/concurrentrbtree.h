@@ -0,0 +1,44 @@
+/**
+ * @file concurrentrbtree.h A red-black tree that many threads can
+ * read while one thread at a time writes.
+ *
+ * Note: like RBTree, the functions in this class do no I/O.
+ */
+
+#ifndef CSCI_311_CONCURRENTRBTREE_H
+#define CSCI_311_CONCURRENTRBTREE_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <shared_mutex>
+#include "rbtree.h"
+
+using std::string;
+using std::vector;
+using std::pair;
+
+class ConcurrentRBTree {
+
+public:
+
+   // writers - hold the lock exclusively
+   void rbInsert(const string& key, const string& value);
+   void rbDelete(const string& key, const string& value);
+   void rbBulkLoad(vector<pair<string, string> >& entries);
+
+   // readers - share the lock, results are copied out before it is
+   // released so they stay valid while writers continue
+   vector<pair<string, string> > rbFind(const string& key);
+   vector<pair<string, string> > rbRange(const string& lo, const string& hi);
+   vector<pair<string, string> > rbPrefix(const string& prefix);
+
+private:
+
+   RBTree tree;                        // the tree being shared
+   std::shared_timed_mutex treeLock;   // shared by readers, owned by writers
+
+   vector<pair<string, string> > copyRange(const RBTree::Range&);
+};
+
+#endif // CSCI_311_CONCURRENTRBTREE_H
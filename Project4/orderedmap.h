@@ -0,0 +1,130 @@
+/**
+ * @file orderedmap.h The ordered multimap interface RBapp and RBStore
+ * run on, so the tree engine can be chosen when the program starts.
+ *
+ * Note: like the trees, the functions in this class do no I/O except
+ * rbPrintTree.
+ */
+
+#ifndef CSCI_311_ORDEREDMAP_H
+#define CSCI_311_ORDEREDMAP_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <functional>
+
+using std::string;
+using std::vector;
+using std::pair;
+
+class OrderedMap {
+
+public:
+
+   // called with the key and value of each entry a scan reaches
+   typedef std::function<void(const string&, const string&)> Visitor;
+
+   virtual ~OrderedMap() {}
+
+   virtual void rbInsert(const string& key, const string& value) = 0;
+   virtual void rbDelete(const string& key, const string& value) = 0;
+   virtual vector<const string*> rbFind(const string& key) = 0;
+   // visits, in key order, every entry whose key is in keys, which
+   // must be sorted and distinct
+   virtual void findSorted(const vector<string>& keys, const Visitor&) = 0;
+   virtual void rbPrintTree() = 0;
+   virtual void rbBulkLoad(vector<pair<string, string> >& entries) = 0;
+
+   // scans in key order
+   virtual void rbRange(const string& lo, const string& hi, const Visitor&) = 0;
+   virtual void rbPrefix(const string& prefix, const Visitor&) = 0;
+   virtual void forEach(const Visitor&) = 0;
+
+   // order statistics; select gives the key and value of the i-th
+   // entry from 0, or two nullptrs if there are no more than i entries
+   virtual unsigned int rank(const string& key) = 0;
+   virtual pair<const string*, const string*> select(unsigned int i) = 0;
+   virtual unsigned int countRange(const string& lo, const string& hi) = 0;
+};
+
+// Adapts any tree with RBTree's interface, such as RBTree or BPTree.
+template <class Tree>
+class TreeMap : public OrderedMap {
+
+public:
+
+   void rbInsert(const string& key, const string& value) {
+      tree.rbInsert(key, value);
+   }
+   void rbDelete(const string& key, const string& value) {
+      tree.rbDelete(key, value);
+   }
+   vector<const string*> rbFind(const string& key) {
+      return tree.rbFind(key);
+   }
+   // One walk forward through the entries. The next key is reached
+   // by stepping when it is at most SEEK_AFTER entries on, and by a
+   // lowerBound descent when it is further.
+   void findSorted(const vector<string>& keys, const Visitor& visit) {
+      if(keys.empty()) {
+         return;
+      }
+      typename Tree::Iterator it = tree.lowerBound(keys[0]);
+      for(unsigned int k = 0; k < keys.size(); k++) {
+         unsigned int steps = 0;
+         while(it != tree.end() && it.key() < keys[k]) {
+            if(++steps > SEEK_AFTER) {
+               it = tree.lowerBound(keys[k]);
+               break;
+            }
+            ++it;
+         }
+         for(; it != tree.end() && it.key() == keys[k]; ++it) {
+            visit(it.key(), it.value());
+         }
+      }
+   }
+   void rbPrintTree() {
+      tree.rbPrintTree();
+   }
+   void rbBulkLoad(vector<pair<string, string> >& entries) {
+      tree.rbBulkLoad(entries);
+   }
+   void rbRange(const string& lo, const string& hi, const Visitor& visit) {
+      scan(tree.rbRange(lo, hi), visit);
+   }
+   void rbPrefix(const string& prefix, const Visitor& visit) {
+      scan(tree.rbPrefix(prefix), visit);
+   }
+   void forEach(const Visitor& visit) {
+      scan(typename Tree::Range(tree.begin(), tree.end()), visit);
+   }
+   unsigned int rank(const string& key) {
+      return tree.rank(key);
+   }
+   pair<const string*, const string*> select(unsigned int i) {
+      typename Tree::Iterator it = tree.select(i);
+      if(it == tree.end()) {
+         return pair<const string*, const string*>(nullptr, nullptr);
+      }
+      return std::make_pair(&it.key(), &it.value());
+   }
+   unsigned int countRange(const string& lo, const string& hi) {
+      return tree.countRange(lo, hi);
+   }
+
+private:
+
+   static const unsigned int SEEK_AFTER = 8;
+
+   Tree tree;
+
+   void scan(const typename Tree::Range& range, const Visitor& visit) {
+      for(typename Tree::Iterator it = range.begin(); it != range.end(); ++it) {
+         visit(it.key(), it.value());
+      }
+   }
+};
+
+#endif // CSCI_311_ORDEREDMAP_H
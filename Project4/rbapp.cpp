@@ -11,52 +11,232 @@
  */
  
 #include "rbapp.h"
-#include <sstream>
+#include "rbtree.h"
+#include "bptree.h"
+#include <cctype>
 #include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cstdlib>
+#include <climits>
+#include <algorithm>
+
+// bytes of stdin pipelineLoop reads at a time
+static const unsigned int BLOCK_SIZE = 1 << 20;
+
+/*
+ * @brief Makes an empty tree of the chosen kind
+ *
+ * @param engine RBapp::RED_BLACK or RBapp::BPLUS
+ *
+ * @return a pointer to the new tree
+ */
+static OrderedMap* makeTree(RBapp::Engine engine) {
+   if(engine == RBapp::BPLUS) {
+      return new TreeMap<BPTree>();
+   }
+   return new TreeMap<RBTree>();
+}
 
 /*
  * @brief Default constructor
  *
- * Constructs a RBapp to process commands for a red-black tree
- * with done set to false as default.
+ * @param engine which tree stores the entries, red-black by default
+ *
+ * Constructs a RBapp to process commands for a tree with done set
+ * to false as default.
  */
-RBapp::RBapp() : done(false) {}
+RBapp::RBapp(Engine engine)
+   : done(false), store(nullptr), lastFindValid(false), batchFinds(false) {
+   myTree = makeTree(engine);
+}
+
+/*
+ * @brief Constructor for a tree that outlives the program
+ *
+ * @param path a reference to the base name of the snapshot and log
+ * files
+ * @param engine which tree stores the entries, red-black by default
+ *
+ * Rebuilds the tree from path.snap and path.log, then logs every
+ * change made to it from here on. The files do not depend on the
+ * engine.
+ */
+RBapp::RBapp(const string& path, Engine engine)
+   : done(false), lastFindValid(false), batchFinds(false) {
+   myTree = makeTree(engine);
+   store = new RBStore(path);
+   store->recover(*myTree);
+}
+
+/*
+ * @brief Destructor
+ *
+ * Deleting the store commits anything still waiting in the log.
+ */
+RBapp::~RBapp() {
+   delete store;
+   delete myTree;
+}
 
 /*
  * @brief Calls processCommand while done is false.
  *
  * @return nothing
+ *
+ * Output is written after every command so it shows up right away
+ * when commands are typed in.
  */
 void RBapp::mainLoop() {
    while(done == false) {
       processCommand();
+      flushOutput();
+   }
+}
+
+/*
+ * @brief Processes commands until done, reading stdin in large blocks
+ *
+ * @return nothing
+ *
+ * For replaying long command files. Reads BLOCK_SIZE bytes at a time
+ * and runs every complete line in the block straight out of the
+ * buffer. Runs of consecutive finds are held and answered together
+ * by answerFinds when another command comes or the block ends.
+ * Output is only written out at the end of each block (or before a
+ * print), and that is also when a persistent tree commits its log. A
+ * line cut off by the end of a block is moved to the front and
+ * finished by the next read.
+ */
+void RBapp::pipelineLoop() {
+   batchFinds = true;
+   vector<char> block(BLOCK_SIZE);
+   size_t filled = 0;
+   while(done == false) {
+      std::cin.read(block.data() + filled, block.size() - filled);
+      size_t readBytes = std::cin.gcount();
+      bool atEnd = (readBytes == 0);
+      filled += readBytes;
+      size_t start = 0;
+      while(done == false) {
+         const char* newline = static_cast<const char*>(
+               memchr(block.data() + start, '\n', filled - start));
+         if(newline == nullptr) {
+            break;
+         }
+         runCommand(block.data() + start, newline);
+         start = newline - block.data() + 1;
+      }
+      if(atEnd) {
+         if(done == false && start < filled) {
+            runCommand(block.data() + start, block.data() + filled);
+         }
+         done = true;
+      }
+      answerFinds();
+      filled -= start;
+      memmove(block.data(), block.data() + start, filled);
+      if(filled == block.size()) {
+         block.resize(block.size() * 2);
+      }
+      flushOutput();
+      if(store != nullptr) {
+         store->commit();
+      }
    }
 }
 
 /*
- * @brief Routes commands to the proper processing functions
+ * @brief Reads one command from stdin and processes it
  *
  * @return nothing
  *
- * Takes commands either through command line or from file and
- * routes those commands to the proper process function. If read
+ * Takes commands either through command line or from file. If read
  * from a file if the end is reached done will be set to true.
  */
 void RBapp::processCommand() {
    std::string line;
    getline(std::cin, line);
-   std::istringstream input(line);
-   std::string command;
-   input >> command;
-   line = line.substr(line.find_first_of(" \t")+1);
+   runCommand(line.data(), line.data() + line.size());
+}
+
+/*
+ * @brief Routes a command line to the proper processing function
+ *
+ * @param begin a pointer to the first character of the line
+ * @param end a pointer just past the last character of the line
+ *
+ * @return nothing
+ *
+ * Splits the line in place into the command word and up to two
+ * arguments, copying them into buffers that are reused from line to
+ * line so no memory is allocated once they have grown. The arguments
+ * start after the first blank in the line; the first argument ends
+ * at the next space and the second is the rest of the line after the
+ * next blank. An unknown command sets done to true.
+ */
+void RBapp::runCommand(const char* begin, const char* end) {
+   const char* commandStart = begin;
+   while(commandStart != end && (*commandStart == ' ' || *commandStart == '\t')) {
+      commandStart++;
+   }
+   const char* commandEnd = commandStart;
+   while(commandEnd != end && !isspace((unsigned char)*commandEnd)) {
+      commandEnd++;
+   }
+   command.assign(commandStart, commandEnd);
+   if(command != "find") {
+      answerFinds();
+   }
+
+   const char* rest = begin;
+   while(rest != end && *rest != ' ' && *rest != '\t') {
+      rest++;
+   }
+   rest = (rest == end) ? begin : rest + 1;
+   const char* firstEnd = rest;
+   while(firstEnd != end && *firstEnd != ' ') {
+      firstEnd++;
+   }
+   const char* secondStart = rest;
+   while(secondStart != end && *secondStart != ' ' && *secondStart != '\t') {
+      secondStart++;
+   }
+   secondStart = (secondStart == end) ? rest : secondStart + 1;
+
    if(command == "insert") {
-      processInsert(line);
+      first.assign(rest, firstEnd);
+      second.assign(secondStart, end);
+      processInsert(first, second);
    } else if(command == "print") {
       processPrint();
    } else if(command == "find") {
-      processFind(line);
+      first.assign(rest, end);
+      processFind(first);
    } else if(command == "delete") {
-      processDelete(line);
+      first.assign(rest, firstEnd);
+      second.assign(secondStart, end);
+      processDelete(first, second);
+   } else if(command == "range") {
+      first.assign(rest, firstEnd);
+      second.assign(secondStart, end);
+      processRange(first, second);
+   } else if(command == "prefix") {
+      first.assign(rest, end);
+      processPrefix(first);
+   } else if(command == "load") {
+      first.assign(rest, end);
+      processLoad(first);
+   } else if(command == "rank") {
+      first.assign(rest, end);
+      processRank(first);
+   } else if(command == "select") {
+      first.assign(rest, end);
+      processSelect(first);
+   } else if(command == "count") {
+      first.assign(rest, firstEnd);
+      second.assign(secondStart, end);
+      processCount(first, second);
    } else if(command == "quit") {
       processQuit();
    } else {
@@ -65,30 +245,50 @@ void RBapp::processCommand() {
 }
 
 /*
- * @brief Processes the info passed in to properly call rbInsert
+ * @brief Writes everything buffered for stdout
  *
- * @param line a reference to a string of information to be used
- * for a call to rbInsert
+ * @return nothing
+ */
+void RBapp::flushOutput() {
+   if(!outBuffer.empty()) {
+      std::cout.write(outBuffer.data(), outBuffer.size());
+      outBuffer.clear();
+   }
+   std::cout.flush();
+}
+
+/*
+ * @brief Inserts a key and value into the tree
+ *
+ * @param key a reference to the key to insert
+ * @param value a reference to the value to go with it
  *
  * @return nothing
  *
- * Divides line into key and value parts for the rbInsert function
- * call.
+ * The insert is logged when the tree is persistent.
  */
-void RBapp::processInsert(string& line) {
-   int pos = line.find(' ');
-   string key = line.substr(0, pos);
-   line = line.substr(line.find_first_of(" \t")+1);
-   myRBT.rbInsert(key, line);
+void RBapp::processInsert(const string& key, const string& value) {
+   myTree->rbInsert(key, value);
+   lastFindValid = false;
+   if(store != nullptr) {
+      store->logInsert(key, value);
+      if(store->snapshotDue()) {
+         store->snapshot(*myTree);
+      }
+   }
 }
 
 /*
  * @brief Calls the print function on the red-black tree
  *
  * @return nothing
+ *
+ * Buffered output is written first since rbPrintTree prints
+ * straight to std::cout.
  */
 void RBapp::processPrint() {
-   myRBT.rbPrintTree();
+   flushOutput();
+   myTree->rbPrintTree();
 }
 
 /*
@@ -100,35 +300,225 @@ void RBapp::processPrint() {
  *
  * Calls rbFind on a given key and makes a list of all of the 
  * instances of that key found in the tree. Once the list is made,
- * it is iterated through and using std::cout the key and value
- * of every instance found is printed.
+ * it is iterated through and the key and value of every instance
+ * found is added to the output. Runs of finds for the same key with
+ * no insert or delete in between reuse the first one's output. When
+ * finds are batched, the key is only held for answerFinds.
  */
-void RBapp::processFind(string& key) {
-   vector<const string*> foundList = myRBT.rbFind(key);
+void RBapp::processFind(const string& key) {
+   if(batchFinds) {
+      pendingFinds.push_back(key);
+      return;
+   }
+   if(lastFindValid && key == lastFind) {
+      outBuffer += lastFindOutput;
+      return;
+   }
+   lastFindOutput.clear();
+   vector<const string*> foundList = myTree->rbFind(key);
    for(vector<const string*>::iterator it = foundList.begin();
          it != foundList.end(); it++) {
-            std::cout << *(*it) << " ";
+            lastFindOutput += *(*it);
+            lastFindOutput += ' ';
             it++;
-            std::cout << *(*it) << std::endl;
+            lastFindOutput += *(*it);
+            lastFindOutput += '\n';
          }
+   outBuffer += lastFindOutput;
+   lastFind = key;
+   lastFindValid = true;
 }
 
 /*
- * @brief Processes the info passed in to properly call rbDelete
+ * @brief Answers the finds held by processFind
  *
- * @param line a reference to a string containing the key and
- * value of a node to be deleted from the tree
+ * @return nothing
+ *
+ * Sorts the distinct keys and gets every matching entry from one
+ * findSorted walk through the tree, instead of a descent per find.
+ * Each find's output is then added in the order the finds came.
+ */
+void RBapp::answerFinds() {
+   if(pendingFinds.empty()) {
+      return;
+   }
+   vector<unsigned int> order(pendingFinds.size());
+   for(unsigned int i = 0; i < order.size(); i++) {
+      order[i] = i;
+   }
+   std::sort(order.begin(), order.end(), [this](unsigned int lhs, unsigned int rhs) {
+      return pendingFinds[lhs] < pendingFinds[rhs];
+   });
+   // slot[i] is the place of find i's key among the distinct keys
+   vector<string> keys;
+   vector<unsigned int> slot(pendingFinds.size());
+   for(unsigned int i = 0; i < order.size(); i++) {
+      if(keys.empty() || keys.back() != pendingFinds[order[i]]) {
+         keys.push_back(pendingFinds[order[i]]);
+      }
+      slot[order[i]] = keys.size() - 1;
+   }
+   // the output for keys[k] is answers from answerStart[k] to
+   // answerStart[k + 1]
+   string answers;
+   vector<size_t> answerStart(keys.size() + 1, 0);
+   unsigned int at = 0;
+   myTree->findSorted(keys, [&](const string& key, const string& value) {
+      while(keys[at] < key) {
+         answerStart[++at] = answers.size();
+      }
+      answers += key;
+      answers += ' ';
+      answers += value;
+      answers += '\n';
+   });
+   while(at < keys.size()) {
+      answerStart[++at] = answers.size();
+   }
+   for(unsigned int i = 0; i < pendingFinds.size(); i++) {
+      outBuffer.append(answers, answerStart[slot[i]],
+                       answerStart[slot[i] + 1] - answerStart[slot[i]]);
+   }
+   pendingFinds.clear();
+}
+
+/*
+ * @brief Deletes every entry with a key and value from the tree
+ *
+ * @param key a reference to the key of the entries to delete
+ * @param value a reference to the value of the entries to delete
+ *
+ * @return nothing
+ *
+ * The delete is logged when the tree is persistent.
+ */
+void RBapp::processDelete(const string& key, const string& value) {
+   myTree->rbDelete(key, value);
+   lastFindValid = false;
+   if(store != nullptr) {
+      store->logDelete(key, value);
+      if(store->snapshotDue()) {
+         store->snapshot(*myTree);
+      }
+   }
+}
+
+/*
+ * @brief Prints every entry whose key falls in [lo, hi)
+ *
+ * @param lo a reference to the smallest key to print
+ * @param hi a reference to the first key past the range
+ *
+ * @return nothing
+ *
+ * Outputs the key and value of each entry in the range as the tree
+ * is walked, in key order.
+ */
+void RBapp::processRange(const string& lo, const string& hi) {
+   myTree->rbRange(lo, hi, [this](const string& key, const string& value) {
+      outBuffer += key;
+      outBuffer += ' ';
+      outBuffer += value;
+      outBuffer += '\n';
+   });
+}
+
+/*
+ * @brief Prints every entry whose key starts with a prefix
+ *
+ * @param prefix a reference to a string the keys must start with
+ *
+ * @return nothing
+ *
+ * Outputs the key and value of each matching entry as the tree is
+ * walked, in key order.
+ */
+void RBapp::processPrefix(const string& prefix) {
+   myTree->rbPrefix(prefix, [this](const string& key, const string& value) {
+      outBuffer += key;
+      outBuffer += ' ';
+      outBuffer += value;
+      outBuffer += '\n';
+   });
+}
+
+/*
+ * @brief Inserts every entry of a file in one bulk load
+ *
+ * @param fileName a reference to a string naming a file with one
+ * "key value" pair per line, like the arguments of insert
  *
  * @return nothing
  *
- * Line is taken apart to get the kay and value needed to properly
- * call the rbDelete function.
+ * Reads the whole file, splitting each line the same way
+ * processInsert does, then hands the batch to rbBulkLoad instead of
+ * inserting one line at a time. Sorted files load fastest. When the
+ * tree is persistent a snapshot is written rather than logging every
+ * entry of the file.
  */
-void RBapp::processDelete(string& line) {
-   int pos = line.find(' ');
-   string key = line.substr(0, pos);
-   line = line.substr(line.find_first_of(" \t")+1);
-   myRBT.rbDelete(key, line);
+void RBapp::processLoad(const string& fileName) {
+   std::ifstream file(fileName);
+   vector<pair<string, string> > entries;
+   string line;
+   while(getline(file, line)) {
+      int pos = line.find(' ');
+      string key = line.substr(0, pos);
+      entries.push_back(std::make_pair(key, line.substr(line.find_first_of(" \t")+1)));
+   }
+   myTree->rbBulkLoad(entries);
+   lastFindValid = false;
+   if(store != nullptr) {
+      store->snapshot(*myTree);
+   }
+}
+
+/*
+ * @brief Prints how many entries have a key smaller than a key
+ *
+ * @param key a reference to the key to compare against
+ *
+ * @return nothing
+ */
+void RBapp::processRank(const string& key) {
+   outBuffer += std::to_string(myTree->rank(key));
+   outBuffer += '\n';
+}
+
+/*
+ * @brief Prints the entry at a position in key order
+ *
+ * @param index a reference to a string holding the position,
+ * counting from 0
+ *
+ * @return nothing
+ *
+ * Prints nothing if the tree does not have that many entries.
+ */
+void RBapp::processSelect(const string& index) {
+   unsigned long i = strtoul(index.c_str(), nullptr, 10);
+   if(i > UINT_MAX) {
+      return;
+   }
+   pair<const string*, const string*> entry = myTree->select(i);
+   if(entry.first != nullptr) {
+      outBuffer += *entry.first;
+      outBuffer += ' ';
+      outBuffer += *entry.second;
+      outBuffer += '\n';
+   }
+}
+
+/*
+ * @brief Prints how many entries have keys in [lo, hi)
+ *
+ * @param lo a reference to the smallest key to count
+ * @param hi a reference to the first key past the range
+ *
+ * @return nothing
+ */
+void RBapp::processCount(const string& lo, const string& hi) {
+   outBuffer += std::to_string(myTree->countRange(lo, hi));
+   outBuffer += '\n';
 }
 
 /*
@@ -144,11 +534,39 @@ void RBapp::processQuit() {
  * @brief Main function of rbapp.cpp
  *
  * Creates a new RBapp, starts the mainLoop to process commands,
- * then deletes the RBapp to free up any memory used.
+ * then deletes the RBapp to free up any memory used. Given a path
+ * argument, the tree is restored from and saved to path.snap and
+ * path.log. With -p, commands are read in blocks by pipelineLoop.
+ * With -b, the entries are kept in a B+-tree instead of a red-black
+ * tree.
+ *
+ * Usage: rbapp [-p] [-b] [path]
  */
-int main() {
-   RBapp* myRBapp = new RBapp();
-   myRBapp->mainLoop();
+int main(int argc, char** argv) {
+   bool pipelined = false;
+   RBapp::Engine engine = RBapp::RED_BLACK;
+   string path;
+   for(int i = 1; i < argc; i++) {
+      if(string(argv[i]) == "-p") {
+         pipelined = true;
+      } else if(string(argv[i]) == "-b") {
+         engine = RBapp::BPLUS;
+      } else {
+         path = argv[i];
+      }
+   }
+   RBapp* myRBapp;
+   if(!path.empty()) {
+      myRBapp = new RBapp(path, engine);
+   } else {
+      myRBapp = new RBapp(engine);
+   }
+   if(pipelined) {
+      std::ios::sync_with_stdio(false);
+      myRBapp->pipelineLoop();
+   } else {
+      myRBapp->mainLoop();
+   }
    delete myRBapp;
    return 0;
 }
\ No newline at end of file
@@ -12,22 +12,46 @@
 #define CSCI_311_RBAPP_H
 
 #include <string>
-#include "rbtree.h"
+#include "orderedmap.h"
+#include "rbstore.h"
 
 using std::string;
 
 class RBapp {
     public:
-        RBapp();                       // constructor
+        enum Engine { RED_BLACK, BPLUS };   // tree that holds the entries
+        RBapp(Engine = RED_BLACK);     // constructor
+        RBapp(const string&, Engine = RED_BLACK);   // persist to a path
+        ~RBapp();                      // destructor
         void mainLoop();               // process commands until done
+        void pipelineLoop();           // same, reading stdin in blocks
     private:
-        RBTree myRBT;                  // the red black tree
+        OrderedMap* myTree;            // the tree, red-black or B+
         bool done;                     // flag for quit
+        RBStore* store;                // log and snapshots, or nullptr
+        string command;                // reused buffers for parsed words
+        string first;
+        string second;
+        string outBuffer;              // output not yet written to stdout
+        string lastFind;               // key of the last find answered
+        string lastFindOutput;         // what that find printed
+        bool lastFindValid;            // no write since lastFind
+        bool batchFinds;               // hold finds until the run ends
+        vector<string> pendingFinds;   // keys of the held finds, in order
         void processCommand();         // read and process one command
-        void processInsert(string&);   // insert into red-black tree
+        void runCommand(const char*, const char*);   // process one line
+        void flushOutput();            // write outBuffer to stdout
+        void processInsert(const string&, const string&);  // insert
         void processPrint();           // print tree
-        void processFind(string&);     // find & print all occurances of a key
-        void processDelete(string&);   // delete from the red-black tree
+        void processFind(const string&);   // find & print all occurances of a key
+        void answerFinds();            // answer the held finds in one pass
+        void processDelete(const string&, const string&);  // delete
+        void processRange(const string&, const string&);   // print [lo, hi)
+        void processPrefix(const string&); // print all keys with a prefix
+        void processLoad(const string&);   // bulk insert from a file
+        void processRank(const string&);   // print how many keys are smaller
+        void processSelect(const string&); // print the i-th entry
+        void processCount(const string&, const string&);   // count [lo, hi)
         void processQuit();
 };
 
@@ -0,0 +1,271 @@
+/*
+ * @file rbbench.cpp Measures insert and find speed and memory use of
+ * the red-black tree and the B+-tree.
+ *
+ * @brief Inserts random word keys with short values, then looks every
+ * key up again. Every heap allocation made while inserting is counted
+ * by replacing the global operator new, so the bytes and allocations
+ * per entry include the keys and values as well as the nodes. The
+ * same entries are then loaded in one rbBulkLoad for comparison.
+ * Both trees are measured this way at each size given, and on
+ * deleting from a key that many entries share. Finally a
+ * ConcurrentRBTree is read by 1 to 8 threads at once while another
+ * thread keeps inserting and deleting.
+ *
+ * Usage: rbbench [entries...]
+ */
+
+#include "rbtree.h"
+#include "bptree.h"
+#include "concurrentrbtree.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include <atomic>
+
+using std::cout;
+using std::vector;
+using std::string;
+
+typedef std::chrono::steady_clock Clock;
+
+// running totals kept by the replacement operator new; counting is
+// switched off before any threads start
+static unsigned long allocatedBytes = 0;
+static unsigned long allocations = 0;
+static bool counting = true;
+
+// finds each reader thread makes in the concurrent measurement
+static const unsigned int READS_PER_THREAD = 200000;
+
+void* operator new(std::size_t size) {
+   if(counting) {
+      allocatedBytes += size;
+      allocations++;
+   }
+   void* p = std::malloc(size == 0 ? 1 : size);
+   if(p == nullptr) {
+      throw std::bad_alloc();
+   }
+   return p;
+}
+
+void operator delete(void* p) noexcept {
+   std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+   std::free(p);
+}
+
+/*
+ * @brief Makes random lowercase keys of 4 to 12 letters.
+ *
+ * @param count the number of keys to make
+ *
+ * @return the keys, which may repeat
+ */
+vector<string> makeKeys(unsigned int count) {
+   std::mt19937 gen(311);
+   std::uniform_int_distribution<int> length(4, 12);
+   std::uniform_int_distribution<int> letter('a', 'z');
+   vector<string> keys(count);
+   for(unsigned int i = 0; i < count; i++) {
+      int n = length(gen);
+      for(int j = 0; j < n; j++) {
+         keys[i] += (char)letter(gen);
+      }
+   }
+   return keys;
+}
+
+/*
+ * @brief Makes a distinct short value for each entry.
+ *
+ * @param count the number of values to make
+ *
+ * @return the values "v0", "v1", ...
+ */
+vector<string> makeValues(unsigned int count) {
+   vector<string> values(count);
+   for(unsigned int i = 0; i < count; i++) {
+      values[i] = "v" + std::to_string(i);
+   }
+   return values;
+}
+
+/*
+ * @brief Times finds from several threads during concurrent writes.
+ *
+ * @param keys the keys to look up and to churn
+ * @param values the values to insert with them
+ * @param readers the number of reader threads
+ *
+ * Prints the combined finds per second of all readers and how many
+ * writes the writer thread got in meanwhile.
+ */
+void concurrentReads(const vector<string>& keys, const vector<string>& values,
+                     unsigned int readers) {
+   ConcurrentRBTree tree;
+   vector<pair<string, string> > batch(keys.size());
+   for(unsigned int i = 0; i < keys.size(); i++) {
+      batch[i] = std::make_pair(keys[i], values[i]);
+   }
+   tree.rbBulkLoad(batch);
+
+   std::atomic<bool> reading(true);
+   std::atomic<unsigned long> writes(0);
+   std::thread writer([&]() {
+      for(unsigned int i = 0; reading; i = (i + 1) % keys.size()) {
+         tree.rbInsert(keys[i], "churn");
+         tree.rbDelete(keys[i], "churn");
+         writes += 2;
+      }
+   });
+   Clock::time_point start = Clock::now();
+   vector<std::thread> threads;
+   for(unsigned int t = 0; t < readers; t++) {
+      threads.push_back(std::thread([&tree, &keys, t]() {
+         for(unsigned int i = 0; i < READS_PER_THREAD; i++) {
+            tree.rbFind(keys[(i * 7919u + t * 104729u) % keys.size()]);
+         }
+      }));
+   }
+   for(unsigned int t = 0; t < readers; t++) {
+      threads[t].join();
+   }
+   double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+   reading = false;
+   writer.join();
+   cout << "   " << readers << " reader" << (readers == 1 ? ": " : "s: ")
+        << (unsigned long)(readers * READS_PER_THREAD / seconds)
+        << " finds/s, " << (unsigned long)(writes / seconds) << " writes/s\n";
+}
+
+/*
+ * @brief Prints a rate in operations per second.
+ *
+ * @param name the operation
+ * @param count how many operations were timed
+ * @param start when the first operation began
+ */
+void printRate(const string& name, unsigned int count, Clock::time_point start) {
+   double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+   cout << "   " << name << ": " << (unsigned long)(count / seconds) << " ops/s\n";
+}
+
+/*
+ * @brief Times inserts, finds, destruction and a bulk load of a tree.
+ *
+ * @param name the name of the tree to print
+ * @param keys the keys to insert and look up
+ * @param values the values to insert with them
+ */
+template <class Tree>
+void measure(const string& name, const vector<string>& keys,
+             const vector<string>& values) {
+   unsigned int count = keys.size();
+   cout << name << ", " << count << " entries\n";
+   Clock::time_point start;
+   {
+      Tree tree;
+      unsigned long bytesBefore = allocatedBytes;
+      unsigned long allocationsBefore = allocations;
+      start = Clock::now();
+      for(unsigned int i = 0; i < count; i++) {
+         tree.rbInsert(keys[i], values[i]);
+      }
+      printRate("insert", count, start);
+      cout << "   heap bytes per entry: "
+           << (double)(allocatedBytes - bytesBefore) / count << "\n";
+      cout << "   allocations per entry: "
+           << (double)(allocations - allocationsBefore) / count << "\n";
+
+      unsigned long found = 0;
+      start = Clock::now();
+      for(unsigned int i = 0; i < count; i++) {
+         found += tree.rbFind(keys[(i * 7919u) % count]).size();
+      }
+      printRate("find", count, start);
+      if(found < 2 * (unsigned long)count) {
+         cout << "   missing entries!\n";
+      }
+      start = Clock::now();
+   }
+   printRate("destroy", count, start);
+
+   vector<pair<string, string> > batch(count);
+   for(unsigned int i = 0; i < count; i++) {
+      batch[i] = std::make_pair(keys[i], values[i]);
+   }
+   {
+      Tree tree;
+      start = Clock::now();
+      tree.rbBulkLoad(batch);
+      printRate("bulk load", count, start);
+   }
+}
+
+/*
+ * @brief Times deleting entries that all share one key.
+ *
+ * @param name the name of the tree to print
+ * @param count the number of entries with the key
+ *
+ * Half the entries have the value "odd" and half "even", alternating,
+ * so the matches of each delete are spread over every leaf or subtree
+ * holding the key, between entries that must stay.
+ */
+template <class Tree>
+void measureDuplicates(const string& name, unsigned int count) {
+   Tree tree;
+   for(unsigned int i = 0; i < count; i++) {
+      tree.rbInsert("duplicate", (i % 2) ? "odd" : "even");
+   }
+   Clock::time_point start = Clock::now();
+   tree.rbDelete("duplicate", "odd");
+   double oddSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+   unsigned long left = tree.rbFind("duplicate").size() / 2;
+   start = Clock::now();
+   tree.rbDelete("duplicate", "even");
+   double evenSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+   cout << name << ", " << count << " entries with one key\n";
+   cout << "   delete half: " << oddSeconds << " s\n";
+   cout << "   delete the rest: " << evenSeconds << " s\n";
+   if(left != count - count / 2 || !tree.rbFind("duplicate").empty()) {
+      cout << "   wrong entries left!\n";
+   }
+}
+
+int main(int argc, char** argv) {
+   vector<unsigned int> counts;
+   for(int i = 1; i < argc; i++) {
+      counts.push_back(atoi(argv[i]));
+   }
+   if(counts.empty()) {
+      counts.push_back(1000000);
+   }
+   for(unsigned int c = 0; c < counts.size(); c++) {
+      vector<string> keys = makeKeys(counts[c]);
+      vector<string> values = makeValues(counts[c]);
+      measure<RBTree>("RBTree", keys, values);
+      measure<BPTree>("BPTree", keys, values);
+      measureDuplicates<RBTree>("RBTree", counts[c]);
+      measureDuplicates<BPTree>("BPTree", counts[c]);
+   }
+
+   counting = false;
+   unsigned int count = counts.back();
+   vector<string> keys = makeKeys(count);
+   vector<string> values = makeValues(count);
+   cout << "ConcurrentRBTree, " << count << " entries, one writer\n";
+   for(unsigned int readers = 1; readers <= 8; readers *= 2) {
+      concurrentReads(keys, values, readers);
+   }
+   return 0;
+}
@@ -0,0 +1,281 @@
+/**
+ * @file rbstore.cpp Keeps the contents of a red-black tree on disk
+ * with a write-ahead log and periodic snapshots.
+ *
+ * @brief Every insert and delete is appended to path.log as the same
+ * text the command was given in. Records are flushed and synced to
+ * disk in groups of GROUP_COMMIT, so a crash loses at most the last
+ * unfinished group. Once the log holds SNAPSHOT_INTERVAL records the
+ * tree is written in order to path.snap and the log starts over.
+ *
+ * Both files begin with a generation number. A snapshot of generation
+ * g holds everything logged up to and including log generation g, so
+ * on recovery a log is only replayed if its generation is newer than
+ * the snapshot's. That keeps a crash between writing a snapshot and
+ * truncating the log from applying the same records twice. A snapshot
+ * ends with an "rbend" line giving its entry count, so one cut short
+ * is never mistaken for a complete one.
+ */
+
+#include <fstream>
+#include <sstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include "rbstore.h"
+
+/*
+ * @brief Syncs the directory holding a file, so a rename into it
+ * survives a crash
+ *
+ * @param path a reference to the name of the file
+ *
+ * @return nothing
+ */
+static void syncDirectory(const string& path) {
+   size_t slash = path.rfind('/');
+   string directory = slash == string::npos ? "." : path.substr(0, slash + 1);
+   int fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+   if(fd >= 0) {
+      fsync(fd);
+      close(fd);
+   }
+}
+
+/*
+ * @brief Constructor
+ *
+ * @param path a reference to the base name of the snapshot and log
+ *
+ * Nothing is opened until recover is called.
+ */
+RBStore::RBStore(const string& path) {
+   snapPath = path + ".snap";
+   logPath = path + ".log";
+   log = nullptr;
+   generation = 0;
+   pending = 0;
+   logged = 0;
+}
+
+/*
+ * @brief Destructor
+ *
+ * Commits any records still waiting and closes the log.
+ */
+RBStore::~RBStore() {
+   if(log != nullptr) {
+      commit();
+      fclose(log);
+   }
+}
+
+/*
+ * @brief Rebuilds a tree from the snapshot and the log
+ *
+ * @param tree a reference to an empty tree to fill
+ *
+ * @return nothing
+ *
+ * The snapshot is read into one batch and handed to rbBulkLoad, which
+ * builds the tree in linear time since the lines are already sorted.
+ * A snapshot whose count line is missing or wrong is ignored. Then
+ * the records of a newer log are applied one by one. A last record
+ * without its newline was cut short by a crash; it is dropped and cut
+ * off the file so new records start on a fresh line. If the
+ * log cannot be reopened the recovered tree is snapshotted instead.
+ */
+void RBStore::recover(OrderedMap& tree) {
+   unsigned long snapGeneration = 0;
+   std::ifstream snap(snapPath);
+   string line;
+   if(snap >> line >> snapGeneration && line == "rbsnap") {
+      getline(snap, line);
+      vector<pair<string, string> > entries;
+      while(getline(snap, line)) {
+         int pos = line.find(' ');
+         entries.push_back(std::make_pair(line.substr(0, pos),
+                                          line.substr(pos + 1)));
+      }
+      if(!entries.empty() && entries.back().first == "rbend" &&
+            entries.back().second == std::to_string(entries.size() - 1)) {
+         entries.pop_back();
+         tree.rbBulkLoad(entries);
+      } else {
+         snapGeneration = 0;
+      }
+   } else {
+      snapGeneration = 0;
+   }
+
+   std::ifstream oldLog(logPath);
+   unsigned long logGeneration = 0;
+   if(oldLog >> line >> logGeneration && line == "rblog" &&
+         logGeneration > snapGeneration) {
+      getline(oldLog, line);
+      long validBytes = oldLog.tellg();
+      while(getline(oldLog, line) && !oldLog.eof()) {
+         validBytes = oldLog.tellg();
+         std::istringstream input(line);
+         string command;
+         input >> command;
+         line = line.substr(line.find(' ') + 1);
+         int pos = line.find(' ');
+         string key = line.substr(0, pos);
+         string value = line.substr(pos + 1);
+         if(command == "insert") {
+            tree.rbInsert(key, value);
+         } else if(command == "delete") {
+            tree.rbDelete(key, value);
+         }
+         logged++;
+      }
+      oldLog.close();
+      generation = logGeneration;
+      if(truncate(logPath.c_str(), validBytes) == 0) {
+         log = fopen(logPath.c_str(), "a");
+      }
+      if(log == nullptr) {
+         snapshot(tree);
+      }
+   }
+   if(log == nullptr) {
+      generation = snapGeneration + 1;
+      logged = 0;
+      startLog();
+   }
+}
+
+/*
+ * @brief Logs an insert
+ *
+ * @param key a reference to the inserted key
+ * @param value a reference to the inserted value
+ *
+ * @return nothing
+ */
+void RBStore::logInsert(const string& key, const string& value) {
+   logRecord("insert", key, value);
+}
+
+/*
+ * @brief Logs a delete
+ *
+ * @param key a reference to the key that was deleted
+ * @param value a reference to the value that was deleted
+ *
+ * @return nothing
+ */
+void RBStore::logDelete(const string& key, const string& value) {
+   logRecord("delete", key, value);
+}
+
+/*
+ * @brief Flushes buffered records and syncs the log to disk
+ *
+ * @return nothing
+ */
+void RBStore::commit() {
+   if(log != nullptr && pending > 0) {
+      fflush(log);
+      fsync(fileno(log));
+      pending = 0;
+   }
+}
+
+/*
+ * @brief Tells whether the log has grown enough to compact
+ *
+ * @return true once SNAPSHOT_INTERVAL records have been logged since
+ * the last snapshot
+ */
+bool RBStore::snapshotDue() {
+   return logged >= SNAPSHOT_INTERVAL;
+}
+
+/*
+ * @brief Writes the whole tree as a snapshot and empties the log
+ *
+ * @param tree a reference to the tree to save
+ *
+ * @return nothing
+ *
+ * The entries are written in order to a temporary file, synced, and
+ * renamed over the old snapshot so a crash leaves either the old or
+ * the new snapshot complete. Only then is the log restarted with the
+ * next generation. If any write fails the temporary file is removed
+ * and the old snapshot and log are kept as they were.
+ */
+void RBStore::snapshot(OrderedMap& tree) {
+   commit();
+   string tempPath = snapPath + ".tmp";
+   FILE* snap = fopen(tempPath.c_str(), "w");
+   if(snap == nullptr) {
+      return;
+   }
+   fprintf(snap, "rbsnap %lu\n", generation);
+   unsigned long count = 0;
+   tree.forEach([snap, &count](const string& key, const string& value) {
+      fwrite(key.data(), 1, key.size(), snap);
+      fputc(' ', snap);
+      fwrite(value.data(), 1, value.size(), snap);
+      fputc('\n', snap);
+      count++;
+   });
+   fprintf(snap, "rbend %lu\n", count);
+   bool written = !ferror(snap) && fflush(snap) == 0 && fsync(fileno(snap)) == 0;
+   written = (fclose(snap) == 0) && written;
+   if(!written || rename(tempPath.c_str(), snapPath.c_str()) != 0) {
+      remove(tempPath.c_str());
+      return;
+   }
+   syncDirectory(snapPath);
+   generation++;
+   logged = 0;
+   startLog();
+}
+
+/*
+ * @brief Appends one record to the log
+ *
+ * @param command the command name, "insert" or "delete"
+ * @param key a reference to the key
+ * @param value a reference to the value
+ *
+ * @return nothing
+ *
+ * Commits once GROUP_COMMIT records are waiting.
+ */
+void RBStore::logRecord(const char* command, const string& key,
+                        const string& value) {
+   if(log == nullptr) {
+      return;
+   }
+   fputs(command, log);
+   fputc(' ', log);
+   fwrite(key.data(), 1, key.size(), log);
+   fputc(' ', log);
+   fwrite(value.data(), 1, value.size(), log);
+   fputc('\n', log);
+   logged++;
+   pending++;
+   if(pending >= GROUP_COMMIT) {
+      commit();
+   }
+}
+
+/*
+ * @brief Starts an empty log for the current generation
+ *
+ * @return nothing
+ */
+void RBStore::startLog() {
+   if(log != nullptr) {
+      fclose(log);
+   }
+   log = fopen(logPath.c_str(), "w");
+   if(log != nullptr) {
+      fprintf(log, "rblog %lu\n", generation);
+      pending = 1;
+      commit();
+   }
+}
@@ -0,0 +1,47 @@
+/**
+ * @file rbstore.h Keeps the contents of a red-black tree on disk with
+ * a write-ahead log and periodic snapshots.
+ */
+
+#ifndef CSCI_311_RBSTORE_H
+#define CSCI_311_RBSTORE_H
+
+#include <string>
+#include <cstdio>
+#include "orderedmap.h"
+
+using std::string;
+
+class RBStore {
+
+public:
+   RBStore(const string& path);      // files are path.snap and path.log
+   ~RBStore();                       // commits anything still pending
+   RBStore(const RBStore&) = delete;
+   RBStore& operator=(const RBStore&) = delete;
+
+   void recover(OrderedMap& tree);   // load snapshot, replay the log tail
+   void logInsert(const string& key, const string& value);
+   void logDelete(const string& key, const string& value);
+   void commit();                    // make logged operations durable
+   bool snapshotDue();               // log long enough to compact
+   void snapshot(OrderedMap& tree);  // write snapshot, start a new log
+
+private:
+   // operations buffered before they are flushed and synced together
+   static const unsigned int GROUP_COMMIT = 64;
+   // operations in the log before a snapshot is worth writing
+   static const unsigned int SNAPSHOT_INTERVAL = 100000;
+
+   string snapPath;                  // sorted "key value" lines, a count
+   string logPath;                   // "insert/delete key value" lines
+   FILE *log;                        // open log, appended to
+   unsigned long generation;         // number in the current log header
+   unsigned int pending;             // logged but not yet committed
+   unsigned int logged;              // records in the current log
+
+   void logRecord(const char*, const string&, const string&);
+   void startLog();                  // truncate the log, write its header
+};
+
+#endif // CSCI_311_RBSTORE_H
@@ -15,6 +15,9 @@
 
 #include <iostream>
 #include <iomanip>
+#include <new>
+#include <algorithm>
+#include <cmath>
 #include "rbtree.h"
 
 using std::cout;
@@ -25,8 +28,9 @@ using std::string;
 /*
  * @brief Default constructor
  *
- * Creates new instances of nil and root. Sets the color of nil
- * and assigns the pointers to nil.
+ * Creates a new instance of nil and points root at it. Sets the
+ * color of nil and assigns the pointers to nil. No slab is allocated
+ * until the first insert.
  */
 RBTree::RBTree() {
    nil = new Node();
@@ -34,29 +38,43 @@ RBTree::RBTree() {
    nil->parent = nil;
    nil->left = nil;
    nil->right = nil;
-   root = new Node();
    root = nil;
+   slabUsed = NODES_PER_SLAB;
+   freeNodes = nullptr;
+   nodeCount = 0;
 }
 
 /*
  * @brief Destructor
  *
- * Goes through the tree and deletes the nodes, once all the nodes
- * have been deleted nodes root and nil get deleted as well.
+ * Clears the tree, then deletes nil.
  */
 RBTree::~RBTree() {
-   while(root->right != nil || root->left != nil) {
-      if(root->right != nil) {
-         rbDelete(root->right);
-      }
-      if(root->left != nil) {
-         rbDelete(root->left);
-      }
-   }
-   delete root;
+   clear();
    delete nil;
 }
 
+/*
+ * @brief Removes every entry from the tree
+ *
+ * @return nothing
+ *
+ * Destroys the nodes in one post-order pass, with no rebalancing,
+ * and then releases the slabs they lived in all at once. Nodes on
+ * the free list are already destroyed and go with their slabs.
+ */
+void RBTree::clear() {
+   rbDestroy(root);
+   for(vector<void*>::iterator it = slabs.begin(); it != slabs.end(); ++it) {
+      ::operator delete(*it);
+   }
+   slabs.clear();
+   slabUsed = NODES_PER_SLAB;
+   freeNodes = nullptr;
+   nodeCount = 0;
+   root = nil;
+}
+
 /*
  * @brief Public function to access the private rbInsert function
  *
@@ -71,7 +89,7 @@ RBTree::~RBTree() {
  * then calls the private rbInsert function passing the node along.
  */
 void RBTree::rbInsert(const string& key, const string& value) {
-   Node* z = new Node(key, value, nil);
+   Node* z = newNode(key, value);
    rbInsert(z);
 }
 
@@ -85,37 +103,96 @@ void RBTree::rbInsert(const string& key, const string& value) {
  *
  * @return Nothing
  *
- * Searches the tree for nodes with matching key and value, and
- * creates a list of all instances of matching nodes. The list is
+ * Walks the nodes from the lower bound to the upper bound of key,
+ * creating a list of all instances of matching nodes. The list is
  * then used to call the private rbDelete function with the node
  * passed along.
  */
 void RBTree::rbDelete(const string& key, const string& value) {
    vector<Node*> dupKeyList;
-    Node *listStart = rbTreeSearch(root, key);
-    if(listStart != nil)
-    {
-        Node *node = listStart;
-        while((node != nil) && (*node->key == key))
-        {
-            dupKeyList.push_back(node);
-            node = rbTreeSuccessor(node);
-        }
-        node = rbTreePredecessor(listStart);
-        while((node != nil) && (*node->key == key))
-        {
-            dupKeyList.push_back(node);
-            node = rbTreePredecessor(node);
-        }
-    }
-    for(vector<Node*>::iterator it = dupKeyList.begin();
-        it != dupKeyList.end(); ++it)
-    {
-        if(*((*it)->value) == value)
-        {
-            rbDelete(*it);
-        }
-    }
+   Node* end = rbUpperBound(key);
+   for(Node* node = rbLowerBound(key); node != end;
+         node = rbTreeSuccessor(node)) {
+      if(node->value == value) {
+         dupKeyList.push_back(node);
+      }
+   }
+   for(vector<Node*>::iterator it = dupKeyList.begin();
+         it != dupKeyList.end(); ++it) {
+      rbDelete(*it);
+   }
+}
+
+/*
+ * @brief Inserts a whole batch of entries at once
+ *
+ * @param entries a reference to a vector of (key, value) pairs; it
+ * is sorted by key (stably) if it is not sorted already
+ *
+ * @return Nothing
+ *
+ * Into an empty tree the sorted batch is built directly as a balanced
+ * red-black tree in O(n). Into a non-empty tree, a batch too small to
+ * be worth it is inserted entry by entry; otherwise the existing
+ * nodes are collected in order, merged with the new ones and the
+ * whole tree is rebuilt in O(n + m). Either way entries with equal
+ * keys end up after the ones already in the tree, in batch order,
+ * just as if rbInsert had been called for each.
+ */
+void RBTree::rbBulkLoad(vector<pair<string, string> >& entries) {
+   if(entries.empty()) {
+      return;
+   }
+   if(!std::is_sorted(entries.begin(), entries.end(),
+         [ ](const pair<string, string>& lhs, const pair<string, string>& rhs) {
+            return lhs.first < rhs.first;
+         })) {
+      std::stable_sort(entries.begin(), entries.end(),
+         [ ](const pair<string, string>& lhs, const pair<string, string>& rhs) {
+            return lhs.first < rhs.first;
+         });
+   }
+   unsigned int existing = nodeCount;
+   if(existing > 0 && entries.size() * std::log2(existing + 1.0) < existing) {
+      for(vector<pair<string, string> >::iterator it = entries.begin();
+            it != entries.end(); ++it) {
+         rbInsert(it->first, it->second);
+      }
+      return;
+   }
+
+   vector<Node*> oldNodes;
+   oldNodes.reserve(existing);
+   if(root != nil) {
+      for(Node* node = rbTreeMinimum(root); node != nil;
+            node = rbTreeSuccessor(node)) {
+         oldNodes.push_back(node);
+      }
+   }
+   vector<Node*> newNodes;
+   newNodes.reserve(entries.size());
+   for(vector<pair<string, string> >::iterator it = entries.begin();
+         it != entries.end(); ++it) {
+      newNodes.push_back(newNode(it->first, it->second));
+   }
+   vector<Node*> nodes(oldNodes.size() + newNodes.size());
+   std::merge(oldNodes.begin(), oldNodes.end(), newNodes.begin(), newNodes.end(),
+      nodes.begin(), [ ](const Node* lhs, const Node* rhs) {
+         return lhs->key < rhs->key;
+      });
+
+   // Every level of the rebuilt tree is full except possibly the last.
+   // Colouring that last level red and the rest black gives every path
+   // the same black height; a perfect tree can be all black.
+   int n = nodes.size();
+   int redDepth = 0;
+   while((2 << redDepth) <= n) {
+      redDepth++;
+   }
+   if(((n + 1) & n) == 0) {
+      redDepth = -1;
+   }
+   root = rbBuild(nodes, 0, n - 1, 0, redDepth, nil);
 }
 
 /*
@@ -128,26 +205,18 @@ void RBTree::rbDelete(const string& key, const string& value) {
  * @return a vector list of keys and values matching the specified
  * key that was searched for
  *
- * Searches the tree for all nodes with the matching key and then
- * puts the found node's key and value into a vector. Each one found
- * gets added to the end of the list.
+ * Descends once to the first node with the matching key and then
+ * walks in order up to the first node with a larger key, putting
+ * each found node's key and value into a vector. The duplicates come
+ * out in the order they were inserted, in O(log n + k) for k matches.
  */
 vector<const string*> RBTree::rbFind(const string& key) {
    vector<const string*> nodeList;
-   Node* listStart = rbTreeSearch(root, key);
-   if(listStart != nil) {
-      Node* node = listStart;
-      while(node != nil && *(node->key) == key) {
-         nodeList.push_back(node->key);
-         nodeList.push_back(node->value);
-         node = rbTreeSuccessor(node);
-      }
-      node = rbTreePredecessor(listStart);
-      while(node != nil && *(node->key) == key) {
-         nodeList.push_back(node->key);
-         nodeList.push_back(node->value);
-         node = rbTreePredecessor(node);
-      }
+   Node* end = rbUpperBound(key);
+   for(Node* node = rbLowerBound(key); node != end;
+         node = rbTreeSuccessor(node)) {
+      nodeList.push_back(&node->key);
+      nodeList.push_back(&node->value);
    }
    return nodeList;
 }
@@ -169,16 +238,15 @@ void RBTree::rbPrintTree() {
 /*
  * @brief Default node constructor
  *
- * Creates a new node with all attributes set to nullptr and color
- * set to red.
+ * Creates a new node with empty key and value, all pointers set to
+ * nullptr, color set to red and size 0, which is right for nil.
  */
 RBTree::Node::Node() {
-   key = nullptr;
-   value = nullptr;
    parent = nullptr;
    left = nullptr;
    right = nullptr;
    color = 'R';
+   size = 0;
 }
 
 /*
@@ -191,29 +259,25 @@ RBTree::Node::Node() {
  * @param s a pointer to nil
  *
  * Creates a new node with attributes dictated by the parameters
- * passed in and the color set to red.
+ * passed in, the color set to red and a subtree size of 1.
  */
-RBTree::Node::Node(const string& key, const string& value, Node* s) {
-   string* tempKey = new string(key);
-   string* tempValue = new string(value);
-   this->key = tempKey;
-   this->value = tempValue;
+RBTree::Node::Node(const string& key, const string& value, Node* s)
+   : key(key), value(value) {
    this->parent = s;
    this->right = s;
    this->left = s;
    this->color = 'R';
+   this->size = 1;
 }
 
 /*
  * @brief Destructor
  *
- * Sets parent, right, and left to nullptr, then deletes key and
- * value to free up memory.
+ * Sets parent, right, and left to nullptr. The key and value
+ * strings free their own memory.
  */
 RBTree::Node::~Node() {
    parent = right = left = nullptr;
-   delete key;
-   delete value;
 }
 
 /*
@@ -265,12 +329,11 @@ RBTree::Node* RBTree::rbTreeMaximum(Node* x) {
  * @return a pointer to the node that is the successor
  *
  * Goes down the given nodes' branch of right children to find the
- * smallest key to use as the successor to the given node.
+ * smallest key to use as the successor to the given node. If there
+ * is no right child, climbs to the first ancestor whose left subtree
+ * holds the node. Returns nil after the largest node.
  */
 RBTree::Node* RBTree::rbTreeSuccessor(Node* x) {
-   if(rbTreeSearch(root, *x->key) == nil) {
-      return x;
-   }
    if(x->right != nil) {
       return rbTreeMinimum(x->right);
    }
@@ -291,12 +354,11 @@ RBTree::Node* RBTree::rbTreeSuccessor(Node* x) {
  * @return a pointer to the node that is the predecessor
  *
  * Goes down the given nodes' branch of left children to find the
- * largest key to use as the predecessor to the given node.
+ * largest key to use as the predecessor to the given node. If there
+ * is no left child, climbs to the first ancestor whose right subtree
+ * holds the node. Returns nil before the smallest node.
  */
 RBTree::Node* RBTree::rbTreePredecessor(Node* x) {
-   if(rbTreeSearch(root, *x->key) == nil) {
-      return x;
-   }
    if(x->left != nil) {
       return rbTreeMaximum(x->left);
    }
@@ -322,10 +384,10 @@ RBTree::Node* RBTree::rbTreePredecessor(Node* x) {
  * each node until a match is found. If no match is found does nothing.
  */
 RBTree::Node* RBTree::rbTreeSearch(Node* root, const string& key) {
-   if(root == nil || *(root->key) == key) {
+   if(root == nil || root->key == key) {
       return root;
    }
-   if(key < *(root->key)) {
+   if(key < root->key) {
       return rbTreeSearch(root->left, key);
    } else {
       return rbTreeSearch(root->right, key);
@@ -349,7 +411,7 @@ void RBTree::reverseInOrderPrint(Node *x, int depth) {
    if ( x != nil ) {
       reverseInOrderPrint(x->right, depth+1);
       cout << setw(depth*4+4) << x->color << " ";
-      cout << *(x->key) << " " << *(x->value) << endl;
+      cout << x->key << " " << x->value << endl;
       reverseInOrderPrint(x->left, depth+1);
    }
 }
@@ -362,6 +424,8 @@ void RBTree::reverseInOrderPrint(Node *x, int depth) {
  * @return nothing
  *
  * Rotates the subtree of a given node to help balance out a tree.
+ * y takes over x's subtree size and x's is recounted from its new
+ * children, which keeps every size right through both fixups.
  */
 void RBTree::leftRotate(Node* x) {
    Node* y = x->right;
@@ -379,6 +443,8 @@ void RBTree::leftRotate(Node* x) {
    }
    y->left = x;
    x->parent = y;
+   y->size = x->size;
+   x->size = x->left->size + x->right->size + 1;
 }
 
 /*
@@ -388,7 +454,8 @@ void RBTree::leftRotate(Node* x) {
  *
  * @return nothing
  *
- * Rotates the subtree of a given node to help balance out a tree.
+ * Rotates the subtree of a given node to help balance out a tree,
+ * keeping the subtree sizes the same way as leftRotate.
  */
 void RBTree::rightRotate(Node* x) {
    Node* y = x->left;
@@ -406,6 +473,8 @@ void RBTree::rightRotate(Node* x) {
    }
    y->right = x;
    x->parent = y;
+   y->size = x->size;
+   x->size = x->left->size + x->right->size + 1;
 }
 
 /*
@@ -559,14 +628,16 @@ void RBTree::rbTransplant(Node* u, Node* v) {
  *
  * Inserts a node into the tree following the rules of a binary
  * search tree, then calls InsertFixup to get the rest of the tree
- * in line with the red-black tree requirements.
+ * in line with the red-black tree requirements. Every node passed on
+ * the way down gains one in size.
  */
 void RBTree::rbInsert(Node* z) {
      Node* y = nil;
      Node* x = root;
      while(x != nil) {
         y = x;
-        if(*(z->key) < *(x->key)) {
+        x->size++;
+        if(z->key < x->key) {
            x = x->left;
         } else {
            x = x->right;
@@ -575,7 +646,7 @@ void RBTree::rbInsert(Node* z) {
      z->parent = y;
      if(y == nil) {
         root = z;
-     } else if(*(z->key) < *(y->key)) {
+     } else if(z->key < y->key) {
         y->left = z;
      } else {
         y->right = z;
@@ -583,6 +654,7 @@ void RBTree::rbInsert(Node* z) {
      z->left = nil;
      z->right = nil;
      z->color = 'R';
+     z->size = 1;
      rbInsertFixup(z);
 }
 
@@ -596,12 +668,18 @@ void RBTree::rbInsert(Node* z) {
  * Goes through the tree for the node to be deleted. Performs
  * a transplant to get the correct node into the place of the
  * node to be deleted. Uses the predecessor when the node to
- * be deleted has two children.
+ * be deleted has two children. Every node above the spot that is
+ * actually unlinked (z, or the predecessor that replaces it) loses
+ * one in size, and the predecessor takes over z's size.
  */
 void RBTree::rbDelete(Node* z) {
    Node* x;
    Node* y = z;
    char yColor = y->color;
+   Node* unlinked = (z->left == nil || z->right == nil) ? z : rbTreeMaximum(z->left);
+   for(Node* p = unlinked->parent; p != nil; p = p->parent) {
+      p->size--;
+   }
    if(z->left == nil) {
       x = z->right;
       rbTransplant(z, x);
@@ -627,7 +705,7 @@ void RBTree::rbDelete(Node* z) {
       y->color = z->color;
       */
       //Uses predecessor
-      y = rbTreeMaximum(z->left);
+      y = unlinked;
       yColor = y->color;
       x = y->left;
       if(y->parent == z) {
@@ -641,9 +719,388 @@ void RBTree::rbDelete(Node* z) {
       y->right = z->right;
       y->right->parent = y;
       y->color = z->color;
+      y->size = z->size;
    }
    if(yColor == 'B') {
       rbDeleteFixup(x);
    }
-   delete z;
-}
\ No newline at end of file
+   freeNode(z);
+}
+
+/*
+ * @brief Finds the first node whose key is not less than a given key
+ *
+ * @param key a reference to a string to compare against
+ *
+ * @return a pointer to the leftmost node with a key >= key, or nil if
+ * every key is smaller
+ *
+ * Descends from the root once, remembering the last node where the
+ * search went left.
+ */
+RBTree::Node* RBTree::rbLowerBound(const string& key) {
+   Node* bound = nil;
+   Node* x = root;
+   while(x != nil) {
+      if(x->key < key) {
+         x = x->right;
+      } else {
+         bound = x;
+         x = x->left;
+      }
+   }
+   return bound;
+}
+
+/*
+ * @brief Finds the first node whose key is greater than a given key
+ *
+ * @param key a reference to a string to compare against
+ *
+ * @return a pointer to the leftmost node with a key > key, or nil if
+ * no key is larger
+ *
+ * Descends from the root once, remembering the last node where the
+ * search went left.
+ */
+RBTree::Node* RBTree::rbUpperBound(const string& key) {
+   Node* bound = nil;
+   Node* x = root;
+   while(x != nil) {
+      if(key < x->key) {
+         bound = x;
+         x = x->left;
+      } else {
+         x = x->right;
+      }
+   }
+   return bound;
+}
+
+/*
+ * @brief Gets an iterator at the smallest entry of the tree
+ *
+ * @return an iterator at the leftmost node, or end() if the tree
+ * is empty
+ */
+RBTree::Iterator RBTree::begin() {
+   if(root == nil) {
+      return end();
+   }
+   return Iterator(this, rbTreeMinimum(root));
+}
+
+/*
+ * @brief Gets the iterator one past the largest entry of the tree
+ *
+ * @return an iterator at nil
+ */
+RBTree::Iterator RBTree::end() {
+   return Iterator(this, nil);
+}
+
+/*
+ * @brief Gets an iterator at the first entry with a key >= key
+ *
+ * @param key a reference to the string to compare against
+ *
+ * @return an iterator at rbLowerBound(key)
+ */
+RBTree::Iterator RBTree::lowerBound(const string& key) {
+   return Iterator(this, rbLowerBound(key));
+}
+
+/*
+ * @brief Gets an iterator at the first entry with a key > key
+ *
+ * @param key a reference to the string to compare against
+ *
+ * @return an iterator at rbUpperBound(key)
+ */
+RBTree::Iterator RBTree::upperBound(const string& key) {
+   return Iterator(this, rbUpperBound(key));
+}
+
+/*
+ * @brief Iterator constructor
+ *
+ * @param tree a pointer to the tree being walked
+ * @param node a pointer to the current node, nil for end()
+ */
+RBTree::Iterator::Iterator(RBTree* tree, Node* node) {
+   this->tree = tree;
+   this->node = node;
+}
+
+/*
+ * @brief Gets the key of the current entry
+ *
+ * @return a reference to the key
+ */
+const string& RBTree::Iterator::key() const {
+   return node->key;
+}
+
+/*
+ * @brief Gets the value of the current entry
+ *
+ * @return a reference to the value
+ */
+const string& RBTree::Iterator::value() const {
+   return node->value;
+}
+
+/*
+ * @brief Moves to the next entry in order
+ *
+ * @return a reference to this iterator
+ */
+RBTree::Iterator& RBTree::Iterator::operator++() {
+   node = tree->rbTreeSuccessor(node);
+   return *this;
+}
+
+/*
+ * @brief Compares two iterators
+ *
+ * @return true if both are at the same node
+ */
+bool RBTree::Iterator::operator==(const Iterator& other) const {
+   return node == other.node;
+}
+
+/*
+ * @brief Compares two iterators
+ *
+ * @return true if they are at different nodes
+ */
+bool RBTree::Iterator::operator!=(const Iterator& other) const {
+   return node != other.node;
+}
+
+/*
+ * @brief Gets the entries whose keys fall in a half-open interval
+ *
+ * @param lo a reference to the smallest key to include
+ * @param hi a reference to the first key past the interval
+ *
+ * @return the range of entries with lo <= key < hi, in order; empty
+ * if hi <= lo
+ *
+ * Only the two bounds are searched for; the entries themselves are
+ * reached by walking the range.
+ */
+RBTree::Range RBTree::rbRange(const string& lo, const string& hi) {
+   if(!(lo < hi)) {
+      return Range(end(), end());
+   }
+   return Range(lowerBound(lo), lowerBound(hi));
+}
+
+/*
+ * @brief Gets the entries whose keys begin with a prefix
+ *
+ * @param prefix a reference to the string every key must start with
+ *
+ * @return the range of matching entries, in order
+ *
+ * The keys starting with prefix are exactly those in
+ * [prefix, limit) where limit is prefix with its last byte that can
+ * still be incremented bumped by one and everything after it dropped.
+ * If there is no such byte every key >= prefix matches.
+ */
+RBTree::Range RBTree::rbPrefix(const string& prefix) {
+   string limit = prefix;
+   while(!limit.empty() && (unsigned char)limit.back() == 0xFF) {
+      limit.pop_back();
+   }
+   if(limit.empty()) {
+      return Range(lowerBound(prefix), end());
+   }
+   limit.back() = (char)((unsigned char)limit.back() + 1);
+   return Range(lowerBound(prefix), lowerBound(limit));
+}
+
+/*
+ * @brief Counts the entries whose keys are less than a key
+ *
+ * @param key a reference to the key to compare against
+ *
+ * @return the number of entries with a smaller key, which is also
+ * the index select would give the first entry with key
+ *
+ * Descends once; every time the search goes right, the node and its
+ * whole left subtree are smaller.
+ */
+unsigned int RBTree::rank(const string& key) {
+   unsigned int smaller = 0;
+   Node* x = root;
+   while(x != nil) {
+      if(x->key < key) {
+         smaller += x->left->size + 1;
+         x = x->right;
+      } else {
+         x = x->left;
+      }
+   }
+   return smaller;
+}
+
+/*
+ * @brief Finds the entry at a position in key order
+ *
+ * @param i the position, counting from 0
+ *
+ * @return an iterator at the entry, or end() if the tree has no more
+ * than i entries
+ *
+ * Compares i with the left subtree's size at each node to decide
+ * which way to go.
+ */
+RBTree::Iterator RBTree::select(unsigned int i) {
+   Node* x = root;
+   while(x != nil) {
+      unsigned int left = x->left->size;
+      if(i < left) {
+         x = x->left;
+      } else if(i == left) {
+         break;
+      } else {
+         i -= left + 1;
+         x = x->right;
+      }
+   }
+   return Iterator(this, x);
+}
+
+/*
+ * @brief Counts the entries with keys in a half-open interval
+ *
+ * @param lo a reference to the smallest key to count
+ * @param hi a reference to the first key past the interval
+ *
+ * @return the number of entries with lo <= key < hi; 0 if hi <= lo
+ */
+unsigned int RBTree::countRange(const string& lo, const string& hi) {
+   if(!(lo < hi)) {
+      return 0;
+   }
+   return rank(hi) - rank(lo);
+}
+
+/*
+ * @brief Range constructor
+ *
+ * @param first an iterator at the first entry of the range
+ * @param last an iterator one past the last entry of the range
+ */
+RBTree::Range::Range(const Iterator& first, const Iterator& last)
+   : first(first), last(last) {}
+
+/*
+ * @brief Gets the start of the range
+ *
+ * @return an iterator at the first entry
+ */
+RBTree::Iterator RBTree::Range::begin() const {
+   return first;
+}
+
+/*
+ * @brief Gets the end of the range
+ *
+ * @return an iterator one past the last entry
+ */
+RBTree::Iterator RBTree::Range::end() const {
+   return last;
+}
+
+/*
+ * @brief Builds a node in slab storage
+ *
+ * @param key a reference to the key to copy into the node
+ * @param value a reference to the value to copy into the node
+ *
+ * @return a pointer to a new red node whose links point at nil
+ *
+ * Reuses a freed node if there is one, otherwise takes the next
+ * slot of the newest slab, starting a new slab when it is full.
+ */
+RBTree::Node* RBTree::newNode(const string& key, const string& value) {
+   void* slot;
+   if(freeNodes != nullptr) {
+      slot = freeNodes;
+      freeNodes = *reinterpret_cast<Node**>(freeNodes);
+   } else {
+      if(slabUsed == NODES_PER_SLAB) {
+         slabs.push_back(::operator new(NODES_PER_SLAB * sizeof(Node)));
+         slabUsed = 0;
+      }
+      slot = static_cast<Node*>(slabs.back()) + slabUsed;
+      slabUsed++;
+   }
+   nodeCount++;
+   return new (slot) Node(key, value, nil);
+}
+
+/*
+ * @brief Destroys a node and keeps its slot for reuse
+ *
+ * @param z a pointer to a node made by newNode
+ *
+ * @return nothing
+ */
+void RBTree::freeNode(Node* z) {
+   z->~Node();
+   *reinterpret_cast<Node**>(z) = freeNodes;
+   freeNodes = z;
+   nodeCount--;
+}
+
+/*
+ * @brief Destroys a subtree in post-order
+ *
+ * @param x a pointer to the root of the subtree
+ *
+ * @return nothing
+ *
+ * Runs only the node destructors; the memory stays in the slabs.
+ */
+void RBTree::rbDestroy(Node* x) {
+   if(x != nil) {
+      rbDestroy(x->left);
+      rbDestroy(x->right);
+      x->~Node();
+   }
+}
+
+/*
+ * @brief Links a sorted run of nodes into a balanced subtree
+ *
+ * @param nodes a reference to the nodes in key order
+ * @param lo the index of the first node of the run
+ * @param hi the index of the last node of the run
+ * @param depth the depth the subtree's root will have
+ * @param redDepth the depth whose nodes are coloured red, -1 for none
+ * @param parent a pointer to the parent of the subtree's root
+ *
+ * @return a pointer to the root of the subtree, nil for an empty run
+ *
+ * The middle node becomes the root and the halves on either side are
+ * built the same way, so the subtree sizes never differ by more than
+ * one and every level but the deepest is full.
+ */
+RBTree::Node* RBTree::rbBuild(vector<Node*>& nodes, int lo, int hi,
+                              int depth, int redDepth, Node* parent) {
+   if(lo > hi) {
+      return nil;
+   }
+   int mid = lo + (hi - lo) / 2;
+   Node* x = nodes[mid];
+   x->parent = parent;
+   x->color = (depth == redDepth) ? 'R' : 'B';
+   x->size = hi - lo + 1;
+   x->left = rbBuild(nodes, lo, mid - 1, depth + 1, redDepth, x);
+   x->right = rbBuild(nodes, mid + 1, hi, depth + 1, redDepth, x);
+   return x;
+}
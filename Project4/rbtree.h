@@ -13,9 +13,11 @@
 
 #include <string>
 #include <vector>
+#include <utility>
 
 using std::string;
 using std::vector;
+using std::pair;
 
 class RBTree {
 
@@ -41,8 +43,9 @@ private:
       Node *left;
       Node *right;
       char color;
-      string *key;
-      string *value;
+      unsigned int size;   // nodes in the subtree rooted here, 0 for nil
+      string key;       // short keys and values stay inside the node
+      string value;
    };
    
    Node *root;          // pointer to the root of the red-black tree
@@ -69,6 +72,76 @@ private:
 
    // do not modify anything above this line!
    // you may add private functions below (although you shouldn't need to)
+
+public:
+
+   // In-order iterator over the entries of the tree. Entries with equal
+   // keys come out in the order they were inserted. Any rbInsert or
+   // rbDelete invalidates outstanding iterators.
+   class Iterator {
+   public:
+      const string& key() const;
+      const string& value() const;
+      Iterator& operator++();
+      bool operator==(const Iterator&) const;
+      bool operator!=(const Iterator&) const;
+   private:
+      friend class RBTree;
+      Iterator(RBTree*, Node*);
+      RBTree *tree;
+      Node *node;
+   };
+
+   Iterator begin();                         // smallest entry
+   Iterator end();                           // one past the largest entry
+   Iterator lowerBound(const string& key);   // first entry with key >= key
+   Iterator upperBound(const string& key);   // first entry with key > key
+
+   // Half-open run of entries [first, last) in key order.
+   class Range {
+   public:
+      Range(const Iterator& first, const Iterator& last);
+      Iterator begin() const;
+      Iterator end() const;
+   private:
+      Iterator first;
+      Iterator last;
+   };
+
+   Range rbRange(const string& lo, const string& hi);   // lo <= key < hi
+   Range rbPrefix(const string& prefix);     // keys starting with prefix
+
+   // insert a batch of (key, value) pairs; sorts the batch by key
+   void rbBulkLoad(vector<pair<string, string> >& entries);
+
+   // remove every entry in O(n), with no rebalancing
+   void clear();
+
+   // order statistics, O(log n) from the subtree sizes
+   unsigned int rank(const string& key);     // entries with key < key
+   Iterator select(unsigned int i);          // i-th entry from 0, or end()
+   unsigned int countRange(const string& lo, const string& hi);   // lo <= key < hi
+
+private:
+
+   Node* rbLowerBound(const string&);
+   Node* rbUpperBound(const string&);
+
+   // Nodes are carved out of slabs of NODES_PER_SLAB so an insert
+   // costs no heap allocation at all when key and value fit in the
+   // strings' inline buffers. Freed nodes are chained through their
+   // first word and reused before the slab grows.
+   static const unsigned int NODES_PER_SLAB = 1024;
+   vector<void*> slabs;         // raw storage, released by the destructor
+   unsigned int slabUsed;       // slots handed out from slabs.back()
+   Node *freeNodes;             // destroyed nodes waiting for reuse
+
+   unsigned int nodeCount;      // nodes currently in the tree
+
+   Node* newNode(const string&, const string&);
+   void freeNode(Node*);
+   void rbDestroy(Node*);
+   Node* rbBuild(vector<Node*>&, int, int, int, int, Node*);
 };
 
 #endif // CSCI_311_RBTREE_H
@@ -0,0 +1,80 @@
+/*
+ * @file bucketq.cpp Dial's bucket queue, a min priority queue for
+ * small non-negative integer keys that never go below the last one
+ * taken out.
+ *
+ * An id whose key goes down is inserted again instead of moved; the
+ * caller skips the stale copy when it comes out, by its key.
+ */
+
+#include "bucketq.h"
+
+/*
+ * @brief Default constructor
+ *
+ * The queue needs reset before use.
+ */
+BucketQ::BucketQ() : cursor(0), current(0), count(0) {}
+
+/*
+ * @brief Empties the queue and sizes it for a largest step
+ *
+ * @param maxStep the most a key inserted can be above the last key
+ * taken out, such as the heaviest edge weight
+ *
+ * @return nothing
+ *
+ * Takes maxStep + 1 buckets. They are only reallocated when maxStep
+ * changes; a queue that was emptied by extractMin has nothing left
+ * to clear.
+ */
+void BucketQ::reset(int maxStep) {
+   if(buckets.size() != (size_t)maxStep + 1) {
+      buckets.assign((size_t)maxStep + 1, std::vector<int>());
+   } else if(count != 0) {
+      for(size_t i = 0; i < buckets.size(); i++) {
+         buckets[i].clear();
+      }
+   }
+   cursor = 0;
+   current = 0;
+   count = 0;
+}
+
+/*
+ * @brief Inserts an id
+ *
+ * @param id the id, such as a vertex number
+ * @param key its key, from the last key taken out to maxStep above it
+ *
+ * @return nothing
+ */
+void BucketQ::insert(int id, int key) {
+   buckets[key % buckets.size()].push_back(id);
+   count++;
+}
+
+/*
+ * @brief Takes out an id with the smallest key
+ *
+ * @param key set to the key of the id taken out
+ *
+ * @return the id, or -1 if the queue is empty
+ *
+ * Walks the buckets around from the last key taken out, so the cost
+ * of a run is the number of ids plus the distance the keys cover.
+ */
+int BucketQ::extractMin(int& key) {
+   if(count == 0) {
+      return -1;
+   }
+   while(buckets[current].empty()) {
+      current = (current + 1 == buckets.size()) ? 0 : current + 1;
+      cursor++;
+   }
+   int id = buckets[current].back();
+   buckets[current].pop_back();
+   count--;
+   key = cursor;
+   return id;
+}
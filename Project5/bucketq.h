@@ -0,0 +1,32 @@
+/*
+ * @file bucketq.h Dial's bucket queue, a min priority queue for small
+ * non-negative integer keys that never go below the last one taken
+ * out, as in Dijkstra's algorithm.
+ *
+ * Resources:
+ * https://en.wikipedia.org/wiki/Bucket_queue
+ */
+
+#ifndef CSCI_311_BUCKETQ_H
+#define CSCI_311_BUCKETQ_H
+
+#include <vector>
+#include <cstddef>
+
+class BucketQ {
+public:
+   BucketQ();
+   void reset(int maxStep);
+   void insert(int id, int key);
+   int extractMin(int& key);          // -1 when empty
+private:
+   // ids by key, key k in buckets[k % buckets.size()]; every key in
+   // the queue is within maxStep of cursor, so no two keys share a
+   // bucket
+   std::vector<std::vector<int> > buckets;
+   int cursor;                        // the smallest key there can be
+   size_t current;                    // cursor's bucket
+   size_t count;                      // ids in the queue
+};
+
+#endif // CSCI_311_BUCKETQ_H
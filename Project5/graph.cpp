@@ -5,28 +5,250 @@
  *
  * @author Katherine Jouzapaitis
  * @date 05/08/2016
+ *
+ * Vertex names are only used at the edges of the class: each vertex
+ * gets a number when it is added, and Dijkstra's algorithm runs on
+ * flat arrays indexed by those numbers.
  */
 
 #include "graph.h"
 
 /*
- * @brief Creates a new Vertex and adds it to the vertices map
+ * @brief Default constructor
+ *
+ * @param cacheBytes how many bytes of shortest path trees to keep
+ *
+ * Starts with an empty graph and no shortest path tree, building
+ * whole trees for queries.
+ */
+Graph::Graph(size_t cacheBytes)
+   : finalized(true), cacheBytes(cacheBytes), mode(TREE), heuristic(EUCLIDEAN),
+     queue(BINARY_HEAP), lazyReset(false), landmarkCount(DEFAULT_LANDMARKS), heuristicReady(false),
+     version(0), lightest(0), heaviest(0), placedCount(0), scale(0), landmarks(0) {}
+
+/*
+ * @brief Workspace constructor
+ *
+ * Starts with no tree; the arrays grow to the graph's size on first
+ * use.
+ */
+Graph::Workspace::Workspace() : treeVersion(0) {}
+
+/*
+ * @brief SSPTree constructor
+ *
+ * Starts with no source and no arrays.
+ */
+Graph::SSPTree::SSPTree() : source(-1), epoch(0) {}
+
+/*
+ * @brief Empties the tree before it is built again
+ *
+ * @param vertexCount the number of vertices in the graph
+ * @param lazy whether to move on to a new epoch instead of filling
+ * the arrays
+ *
+ * @return nothing
+ *
+ * A lazy reset costs O(1), except when the arrays are the wrong size
+ * or the epoch wraps around, when the stamps are zeroed and the
+ * epoch starts again from 1.
+ */
+void Graph::SSPTree::reset(int vertexCount, bool lazy) {
+   if(!lazy) {
+      key.assign(vertexCount, INT_MAX);
+      pi.assign(vertexCount, -1);
+      stamp.clear();
+   } else if((int)stamp.size() != vertexCount || ++epoch == 0) {
+      key.resize(vertexCount);
+      pi.resize(vertexCount);
+      stamp.assign(vertexCount, 0);
+      epoch = 1;
+   }
+}
+
+/*
+ * @brief Gives a vertex a distance and predecessor in the tree
+ *
+ * @param v the number of the vertex
+ * @param distance its distance from the source
+ * @param previous the vertex before it, -1 for the source
+ *
+ * @return nothing
+ */
+void Graph::SSPTree::reach(int v, int distance, int previous) {
+   key[v] = distance;
+   pi[v] = previous;
+   if(!stamp.empty()) {
+      stamp[v] = epoch;
+   }
+}
+
+/*
+ * @brief Gets a vertex's distance from the source
+ *
+ * @param v the number of the vertex
+ *
+ * @return the distance, or INT_MAX if v is unreached
+ */
+int Graph::SSPTree::distance(int v) const {
+   return (stamp.empty() || stamp[v] == epoch) ? key[v] : INT_MAX;
+}
+
+/*
+ * @brief Gets the vertex before one in the tree
+ *
+ * @param v the number of the vertex
+ *
+ * @return the vertex before v on its path from the source, or -1 for
+ * the source and unreached vertices
+ */
+int Graph::SSPTree::previous(int v) const {
+   return (stamp.empty() || stamp[v] == epoch) ? pi[v] : -1;
+}
+
+/*
+ * @brief Chooses how getShortestPath searches
+ *
+ * @param mode TREE, EARLY_EXIT or BIDIRECTIONAL
+ *
+ * @return nothing
+ *
+ * Every mode finds a path of the same length, but when several
+ * shortest paths tie they may not pick the same one.
+ */
+void Graph::setMode(Mode mode) {
+   this->mode = mode;
+}
+
+/*
+ * @brief Chooses the heuristic ASTAR mode steers by
+ *
+ * @param heuristic EUCLIDEAN, MANHATTAN or LANDMARKS
+ * @param landmarkCount how many landmarks LANDMARKS picks
+ *
+ * @return nothing
+ *
+ * The heuristic is worked out by the first A* query after this or
+ * any change to the graph: a pass over the edges for the geometric
+ * ones, two Dijkstra runs per landmark for LANDMARKS.
+ */
+void Graph::setHeuristic(Heuristic heuristic, int landmarkCount) {
+   this->heuristic = heuristic;
+   this->landmarkCount = landmarkCount;
+   heuristicReady = false;
+}
+
+/*
+ * @brief Chooses the queue TREE mode builds trees with
+ *
+ * @param queue BINARY_HEAP, BUCKETS or RADIX_HEAP
+ *
+ * @return nothing
+ *
+ * Trees already built are kept; every queue finds the same
+ * distances.
+ */
+void Graph::setQueue(Queue queue) {
+   this->queue = queue;
+}
+
+/*
+ * @brief Chooses whether trees are reset lazily
+ *
+ * @param lazy true to build trees with epoch stamps
+ *
+ * @return nothing
+ *
+ * Normally each tree build fills both of its arrays for every vertex
+ * and puts every vertex in the binary heap. With lazy reset, a new
+ * epoch stands for the filling, and vertices join the queue when an
+ * edge first reaches them, so a build costs the part of the graph
+ * the source reaches. Lazy trees take a stamp per vertex on top.
+ */
+void Graph::setLazyReset(bool lazy) {
+   lazyReset = lazy;
+   dropTrees();
+}
+
+/*
+ * @brief Changes how much memory the cached shortest path trees
+ * may use
+ *
+ * @param bytes the new budget
+ *
+ * @return nothing
+ *
+ * A tree takes two ints per vertex, three with lazy reset. The most
+ * recently used tree is always kept, however small the budget; trees
+ * over the new budget are dropped, least recently used first.
+ */
+void Graph::setCacheBudget(size_t bytes) {
+   cacheBytes = bytes;
+   while(trees.size() > treeLimit()) {
+      treeIndex.erase(trees.back().source);
+      trees.pop_back();
+   }
+}
+
+/*
+ * @brief Makes room for a graph of a known size
+ *
+ * @param vertexCount the number of vertices that will be added
+ * @param edgeCount the number of edges that will be added
+ *
+ * @return nothing
+ *
+ * Optional; saves the tables from growing one step at a time while
+ * a large graph is read in.
+ */
+void Graph::reserve(int vertexCount, int edgeCount) {
+   names.reserve(vertexCount);
+   ids.reserve(vertexCount);
+   pending.reserve(pending.size() + edgeCount);
+}
+
+/*
+ * @brief Numbers a new vertex
+ *
+ * @param name a string containing the name of the vertex
+ *
+ * @return nothing
+ *
+ * Gives the vertex the next free number. Adding a name that is
+ * already in the graph does nothing.
+ */
+void Graph::addVertex(const string& name) {
+   vertexId(name);
+}
+
+/*
+ * @brief Numbers a new vertex and gives it coordinates
  *
  * @param name a string containing the name of the vertex
+ * @param x the first coordinate of the vertex
+ * @param y the second coordinate of the vertex
  *
  * @return nothing
  *
- * Creates a new Vertex for the vertices map. The name will
- * be passed in via parameter the temp Vertex has no initial
- * value and will be assigned later.
+ * Moves the vertex if it is already in the graph.
  */
-void Graph::addVertex(string name) {
-   Vertex* temp = new Vertex();
-   vertices[name] = *temp;
+void Graph::addVertex(const string& name, double x, double y) {
+   int v = vertexId(name);
+   if(xs.size() < names.size()) {
+      xs.resize(names.size(), NAN);
+      ys.resize(names.size(), NAN);
+   }
+   if(std::isnan(xs[v])) {
+      placedCount++;
+   }
+   xs[v] = x;
+   ys[v] = y;
+   heuristicReady = false;
 }
 
 /*
- * @brief Creates a new weighted edge and adds it to the adjList map
+ * @brief Adds a weighted edge to the graph
  *
  * @param from a string containing the name of the vertex the edge
  * will start at
@@ -36,21 +258,28 @@ void Graph::addVertex(string name) {
  *
  * @return nothing
  *
- * Creates a new Neighbor with the name from the to parameter and weight
- * from the weight parameter. Adds the Neighbor to the adjList indexed
- * by the from parameter.
+ * Appends the edge to pending, which costs no allocation of its own;
+ * it joins the rest of the edges at the next finalize. Vertices not
+ * added yet are added. Edges usually come grouped by source, so the
+ * source of the last edge is checked before looking the name up.
  */
-void Graph::addEdge(string from, string to, int weight) {
-   Neighbor* temp = new Neighbor();
-   temp->name = to;
-   temp->weight = weight;
-   adjList[from].push_back(*temp);
-   std::sort(adjList[from].begin(), adjList[from].end(), [ ](const Neighbor& lhs, const Neighbor& rhs) {return (lhs.name < rhs.name);});
+void Graph::addEdge(const string& from, const string& to, int weight) {
+   Edge temp;
+   if(!pending.empty() && names[pending.back().from] == from) {
+      temp.from = pending.back().from;
+   } else {
+      temp.from = vertexId(from);
+   }
+   temp.to = vertexId(to);
+   temp.weight = weight;
+   pending.push_back(temp);
+   finalized = false;
 }
 
 /*
- * @brief Calls buildSSPTree to get the shortest path and puts
- * together the vertex infomation for output using std out
+ * @brief Gets the shortest path tree from the source, from the
+ * cache or by calling buildSSPTree, and puts together the vertex
+ * infomation for output using std out
  *
  * @param from a string containing the name of the starting Vertex
  * in the path
@@ -59,68 +288,567 @@ void Graph::addEdge(string from, string to, int weight) {
  *
  * @return a string listing the Vertices in the path separated by
  * "->", then followed by " with length " and the cost of the entire
- * path.
+ * path; "no path from <from> to <to>" if to cannot be reached or
+ * either name is not in the graph.
+ *
+ * Modes other than TREE search in the graph's own workspace.
  */
-string Graph::getShortestPath(string from, string to) {
-   if(currentSource != from) {
-      buildSSPTree(from);
+string Graph::getShortestPath(const string& from, const string& to) {
+   prepare();
+   if(mode != TREE) {
+      return getShortestPath(from, to, scratch);
    }
-   
-   std::list <string> pathList;
-   pathList.push_front(to);
-   string temp = vertices[to].pi;
-   while(temp != from) {
-      pathList.push_front(temp);
-      temp = vertices[temp].pi;
-   }
-   pathList.push_front(from);
-   
+   std::unordered_map<string, int>::const_iterator source = ids.find(from);
+   std::unordered_map<string, int>::const_iterator target = ids.find(to);
+   vector<int> path;
+   int length = INT_MAX;
+   if(source != ids.end() && target != ids.end()) {
+      length = treePath(shortestPathTree(source->second), target->second, path);
+   }
+   return describe(from, to, path, length);
+}
+
+/*
+ * @brief Finds a shortest path using only the given workspace
+ *
+ * @param from a string containing the name of the starting Vertex
+ * in the path
+ * @param to a string containing the name of the ending Vertex
+ * in the path
+ * @param workspace the scratch space to search in, which no other
+ * thread may be using
+ *
+ * @return the same as the other getShortestPath
+ *
+ * prepare must have been called since the graph last changed; the
+ * graph is not changed, so many threads may call this at once. In
+ * TREE mode, the workspace keeps the last tree it built instead of
+ * the graph's cache, so queries grouped by source build each tree
+ * once.
+ */
+string Graph::getShortestPath(const string& from, const string& to,
+                              Workspace& workspace) const {
+   std::unordered_map<string, int>::const_iterator source = ids.find(from);
+   std::unordered_map<string, int>::const_iterator target = ids.find(to);
+   vector<int> path;
+   int length = INT_MAX;
+   if(source != ids.end() && target != ids.end() && prepared()) {
+      length = shortestPath(source->second, target->second, path, workspace);
+   }
+   return describe(from, to, path, length);
+}
+
+/*
+ * @brief Puts together the answer to a query
+ *
+ * @param from the name of the starting vertex
+ * @param to the name of the ending vertex
+ * @param path the vertex numbers along the path
+ * @param length the length of the path, INT_MAX if there is none
+ *
+ * @return the answer as getShortestPath gives it
+ */
+string Graph::describe(const string& from, const string& to, const vector<int>& path,
+                       int length) const {
+   if(length == INT_MAX) {
+      return "no path from " + from + " to " + to;
+   }
+
    std::stringstream shortPath;
-   for(std::list <string>::iterator it = pathList.begin(); it != pathList.end(); it++) {
-      shortPath << *it;
-      if(*it != to) {
+   for(vector<int>::const_iterator it = path.begin(); it != path.end(); it++) {
+      if(it != path.begin()) {
          shortPath << "->";
       }
+      shortPath << names[*it];
    }
    
-   shortPath << " with length " << vertices[to].key;
+   shortPath << " with length " << length;
    
    return shortPath.str();
 }
 
+/*
+ * @brief Gets the number of a vertex, adding it if it is new
+ *
+ * @param name a string containing the name of the vertex
+ *
+ * @return the vertex number
+ */
+int Graph::vertexId(const string& name) {
+   std::unordered_map<string, int>::iterator found = ids.find(name);
+   if(found != ids.end()) {
+      return found->second;
+   }
+   int id = names.size();
+   ids.insert(std::make_pair(name, id));
+   names.push_back(name);
+   dropTrees();
+   heuristicReady = false;
+   hierarchy.clear();
+   return id;
+}
+
+/*
+ * @brief Finds a shortest path the way the mode says
+ *
+ * @param source the number of the vertex the path starts at
+ * @param target the number of the vertex the path ends at
+ * @param path filled with the vertex numbers along the path, from
+ * source to target
+ * @param workspace the scratch space to search in
+ *
+ * @return the length of the path, or INT_MAX if there is none
+ */
+int Graph::shortestPath(int source, int target, vector<int>& path,
+                        Workspace& workspace) const {
+   path.clear();
+   int length;
+   if(mode == TREE) {
+      SSPTree& tree = workspace.tree;
+      if(tree.source != source || workspace.treeVersion != version ||
+         tree.key.size() != names.size()) {
+         tree.source = source;
+         workspace.treeVersion = version;
+         buildTree(tree, workspace);
+      }
+      return treePath(tree, target, path);
+   } else if(mode == EARLY_EXIT || mode == ASTAR) {
+      Search& forward = workspace.forward;
+      length = (mode == EARLY_EXIT) ? earlyExit(forward, source, target)
+                                    : aStar(forward, source, target);
+      if(length != INT_MAX) {
+         for(int v = target; v != -1; v = forward.pi[v]) {
+            path.push_back(v);
+         }
+      }
+   } else if(mode == CONTRACTED) {
+      return hierarchy.query(source, target, path, workspace.upward, workspace.downward);
+   } else {
+      int meet;
+      length = bidirectional(workspace, source, target, meet);
+      if(length != INT_MAX) {
+         for(int v = meet; v != -1; v = workspace.forward.pi[v]) {
+            path.push_back(v);
+         }
+         std::reverse(path.begin(), path.end());
+         for(int v = workspace.backward.pi[meet]; v != -1; v = workspace.backward.pi[v]) {
+            path.push_back(v);
+         }
+      }
+      return length;
+   }
+   std::reverse(path.begin(), path.end());
+   return length;
+}
+
+/*
+ * @brief Reads a path out of a shortest path tree
+ *
+ * @param tree the tree
+ * @param target the number of the vertex the path ends at
+ * @param path filled with the vertex numbers along the path, from
+ * the tree's source to target
+ *
+ * @return the length of the path, or INT_MAX if there is none
+ */
+int Graph::treePath(const SSPTree& tree, int target, vector<int>& path) const {
+   path.clear();
+   int length = tree.distance(target);
+   if(length != INT_MAX) {
+      for(int v = target; v != -1; v = tree.previous(v)) {
+         path.push_back(v);
+      }
+      std::reverse(path.begin(), path.end());
+   }
+   return length;
+}
+
+/*
+ * @brief Gets the shortest path tree from a source, building it if
+ * it is not cached
+ *
+ * @param source the number of the vertex the tree starts at
+ *
+ * @return the tree, which stays valid until the next call or change
+ * to the graph
+ *
+ * The tree moves to the front of the cache. A new tree reuses the
+ * arrays of the least recently used one when the cache is full.
+ */
+const Graph::SSPTree& Graph::shortestPathTree(int source) {
+   std::unordered_map<int, std::list<SSPTree>::iterator>::iterator found =
+      treeIndex.find(source);
+   if(found != treeIndex.end()) {
+      trees.splice(trees.begin(), trees, found->second);
+      return trees.front();
+   }
+   if(trees.size() >= treeLimit()) {
+      treeIndex.erase(trees.back().source);
+      trees.splice(trees.begin(), trees, --trees.end());
+   } else {
+      trees.push_front(SSPTree());
+   }
+   trees.front().source = source;
+   buildTree(trees.front(), scratch);
+   treeIndex[source] = trees.begin();
+   return trees.front();
+}
+
+/*
+ * @brief Gets how many trees fit in the cache budget
+ *
+ * @return the number of trees, at least 1
+ */
+size_t Graph::treeLimit() {
+   size_t treeBytes = (lazyReset ? 3 : 2) * sizeof(int) * names.size();
+   if(treeBytes == 0 || cacheBytes / treeBytes == 0) {
+      return 1;
+   }
+   return cacheBytes / treeBytes;
+}
+
+/*
+ * @brief Forgets every cached shortest path tree
+ *
+ * @return nothing
+ */
+void Graph::dropTrees() {
+   if(!trees.empty()) {
+      trees.clear();
+      treeIndex.clear();
+   }
+}
+
+/*
+ * @brief Packs the edges into compressed sparse row form
+ *
+ * @return nothing
+ *
+ * Called by getShortestPath when needed; calling it once all the
+ * edges are in keeps that cost out of the first query. Each vertex's
+ * edges end up sorted by the name of the vertex they lead to, with
+ * edges to the same vertex in the order they were added. Instead of
+ * sorting edges by name, the vertices are ranked by name once and
+ * the edges are bucketed twice in O(V + E): by the rank of their
+ * target, then stably by their source. Edges packed by an earlier
+ * finalize are put back in front of pending first. Does nothing if
+ * no edge or vertex has been added since the last time.
+ */
+void Graph::finalize() {
+   if(finalized && offsets.size() == names.size() + 1) {
+      return;
+   }
+   int vertexCount = names.size();
+   if(!targets.empty()) {
+      vector<Edge> packed(targets.size());
+      for(int u = 0; u + 1 < (int)offsets.size(); u++) {
+         for(int i = offsets[u]; i < offsets[u + 1]; i++) {
+            packed[i].from = u;
+            packed[i].to = targets[i];
+            packed[i].weight = weights[i];
+         }
+      }
+      pending.insert(pending.begin(), packed.begin(), packed.end());
+   }
+   int edgeCount = pending.size();
+
+   vector<int> byName(vertexCount);
+   for(int v = 0; v < vertexCount; v++) {
+      byName[v] = v;
+   }
+   std::sort(byName.begin(), byName.end(),
+             [this](int lhs, int rhs) {return (names[lhs] < names[rhs]);});
+   vector<int> nameRank(vertexCount);
+   for(int i = 0; i < vertexCount; i++) {
+      nameRank[byName[i]] = i;
+   }
+
+   vector<int> start(vertexCount + 1, 0);
+   for(int e = 0; e < edgeCount; e++) {
+      start[nameRank[pending[e].to] + 1]++;
+   }
+   for(int r = 0; r < vertexCount; r++) {
+      start[r + 1] += start[r];
+   }
+   vector<int> byTarget(edgeCount);
+   for(int e = 0; e < edgeCount; e++) {
+      byTarget[start[nameRank[pending[e].to]]++] = e;
+   }
+
+   offsets.assign(vertexCount + 1, 0);
+   for(int e = 0; e < edgeCount; e++) {
+      offsets[pending[e].from + 1]++;
+   }
+   for(int u = 0; u < vertexCount; u++) {
+      offsets[u + 1] += offsets[u];
+   }
+   start.assign(offsets.begin(), offsets.end() - 1);
+   targets.resize(edgeCount);
+   weights.resize(edgeCount);
+   lightest = edgeCount ? INT_MAX : 0;
+   heaviest = 0;
+   for(int i = 0; i < edgeCount; i++) {
+      const Edge& edge = pending[byTarget[i]];
+      int slot = start[edge.from]++;
+      targets[slot] = edge.to;
+      weights[slot] = edge.weight;
+      lightest = std::min(lightest, edge.weight);
+      heaviest = std::max(heaviest, edge.weight);
+   }
+   vector<Edge>().swap(pending);
+   finalized = true;
+   version++;
+   dropTrees();
+   heuristicReady = false;
+   hierarchy.clear();
+   reverseOffsets.clear();
+   sources.clear();
+   reverseWeights.clear();
+}
+
+/*
+ * @brief Does everything the mode needs before a query
+ *
+ * @return nothing
+ *
+ * Packs the edges, then builds whatever the mode searches with that
+ * is not built yet: the reverse edges for BIDIRECTIONAL, the
+ * heuristic for ASTAR, the hierarchy for CONTRACTED. Until the graph
+ * changes again, queries only read it.
+ */
+void Graph::prepare() {
+   finalize();
+   if(mode == BIDIRECTIONAL) {
+      buildReverse();
+   } else if(mode == ASTAR) {
+      prepareHeuristic();
+   } else if(mode == CONTRACTED && !hierarchy.built()) {
+      buildHierarchy();
+   }
+}
+
+/*
+ * @brief Tells whether prepare has been called since the graph last
+ * changed
+ *
+ * @return true if a query in the current mode only needs to read
+ * the graph
+ */
+bool Graph::prepared() const {
+   if(!finalized || offsets.size() != names.size() + 1) {
+      return false;
+   }
+   if(mode == BIDIRECTIONAL) {
+      return reverseOffsets.size() == offsets.size();
+   } else if(mode == ASTAR) {
+      return heuristicReady;
+   } else if(mode == CONTRACTED) {
+      return hierarchy.built();
+   }
+   return true;
+}
+
+/*
+ * @brief Contracts the graph into a hierarchy for CONTRACTED mode
+ *
+ * @return nothing
+ *
+ * This is the slow part of CONTRACTED mode, meant to be done once
+ * and saved: queries afterwards only search a small part of the
+ * graph.
+ */
+void Graph::buildHierarchy() {
+   finalize();
+   hierarchy.build(offsets, targets, weights);
+}
+
+/*
+ * @brief Writes the hierarchy to a file
+ *
+ * @param path the name of the file
+ *
+ * @return true if it was written; false if it could not be or no
+ * hierarchy has been built or loaded
+ */
+bool Graph::saveHierarchy(const string& path) {
+   finalize();
+   return hierarchy.save(path);
+}
+
+/*
+ * @brief Reads a hierarchy saved for this graph
+ *
+ * @param path the name of the file
+ *
+ * @return true if the file holds a hierarchy built from exactly
+ * these vertices and edges; otherwise nothing is loaded
+ */
+bool Graph::loadHierarchy(const string& path) {
+   finalize();
+   return hierarchy.load(path, Hierarchy::fingerprint(offsets, targets, weights));
+}
+
+/*
+ * @brief Builds the reverse adjacency if it is not already built
+ *
+ * @return nothing
+ *
+ * Buckets the edges by the vertex they lead to in O(V + E); the
+ * edges into each vertex keep the order of their sources.
+ */
+void Graph::buildReverse() {
+   int vertexCount = names.size();
+   if((int)reverseOffsets.size() == vertexCount + 1) {
+      return;
+   }
+   int edgeCount = targets.size();
+   reverseOffsets.assign(vertexCount + 1, 0);
+   for(int i = 0; i < edgeCount; i++) {
+      reverseOffsets[targets[i] + 1]++;
+   }
+   for(int v = 0; v < vertexCount; v++) {
+      reverseOffsets[v + 1] += reverseOffsets[v];
+   }
+   vector<int> next(reverseOffsets.begin(), reverseOffsets.end() - 1);
+   sources.resize(edgeCount);
+   reverseWeights.resize(edgeCount);
+   for(int u = 0; u < vertexCount; u++) {
+      for(int i = offsets[u]; i < offsets[u + 1]; i++) {
+         int slot = next[targets[i]]++;
+         sources[slot] = u;
+         reverseWeights[slot] = weights[i];
+      }
+   }
+}
+
+/*
+ * @brief Builds a shortest path tree with the queue chosen by
+ * setQueue
+ *
+ * @param tree the tree to fill in, with its source set
+ * @param workspace holds the queues
+ *
+ * @return nothing
+ *
+ * Falls back to the binary heap when the weights do not suit the
+ * queue chosen.
+ */
+void Graph::buildTree(SSPTree& tree, Workspace& workspace) const {
+   if(queue == BUCKETS && lightest >= 0 && heaviest <= MAX_BUCKET_WEIGHT) {
+      workspace.buckets.reset(heaviest);
+      buildSSPTree(tree, workspace.buckets);
+   } else if(queue == RADIX_HEAP && lightest >= 0) {
+      workspace.radix.clear();
+      buildSSPTree(tree, workspace.radix);
+   } else if(lazyReset) {
+      buildSSPTreeLazy(tree, workspace.minQ);
+   } else {
+      buildSSPTree(tree, workspace.minQ);
+   }
+}
+
 /*
  * @brief Using Dijkstra's algorithm and min priority queue to
  * calculate the shortest path from a given source
  *
- * @param source a string containing the name of the Vertex that
- * is the starting point of the shortest path
+ * @param tree the tree to fill in, with its source set
+ * @param minQ the queue to settle the vertices in
  *
  * @return nothing
  *
- * Iterates through the map of vertices giving the source a weight
- * of 0 and every other vertice a weight of INT_MAX. Puts the
- * vertices in the min priority queue, then extracts from the
- * min priority queue to start relaxing the edges to get the
- * appropriate weights assigned as the path is calculated.
+ * Gives the source a key of 0 and every other vertex a key of
+ * INT_MAX. Puts the vertices in the min priority queue, then extracts
+ * from the min priority queue to start relaxing the edges to get the
+ * appropriate keys assigned as the path is calculated. Once the
+ * smallest key left is INT_MAX the rest cannot be reached.
  */
-void Graph::buildSSPTree(string source) { //Dijkstra
-   currentSource = source;
-   for(map<string, Vertex>::iterator it = vertices.begin(); it != vertices.end(); it++) {
-      if(it->first != source) {
-         it->second.key = INT_MAX;
-         it->second.pi = "NIL";
-      } else {
-         it->second.key = 0;
-      }
-      minQ.insert(it->first, it->second.key);
+void Graph::buildSSPTree(SSPTree& tree, MinPriorityQ& minQ) const { //Dijkstra
+   vector<int>& key = tree.key;
+   int vertexCount = names.size();
+   tree.reset(vertexCount, false);
+   key[tree.source] = 0;
+   for(int v = 0; v < vertexCount; v++) {
+      minQ.insert(v, key[v]);
    }
    while(1) {
-      std::string u = minQ.extractMin();
-      if(u == "empty") {
+      int u = minQ.extractMin();
+      if(u == -1) {
          break;
       }
-      for(vector<Neighbor>::iterator it = adjList[u].begin(); it != adjList[u].end(); it++) {
-         relax(u, it->name, it->weight);
+      if(key[u] == INT_MAX) {
+         continue;
+      }
+      for(int i = offsets[u]; i < offsets[u + 1]; i++) {
+         relax(tree, minQ, u, targets[i], weights[i]);
+      }
+   }
+}
+
+/*
+ * @brief Dijkstra's algorithm that only touches the vertices the
+ * source reaches
+ *
+ * @param tree the tree to fill in, with its source set
+ * @param minQ an empty queue to settle the vertices in
+ *
+ * @return nothing
+ *
+ * Like buildSSPTree, but the tree is reset by starting a new epoch,
+ * and a vertex goes in the queue when an edge first reaches it rather
+ * than all at the start, so unreached vertices cost nothing.
+ */
+void Graph::buildSSPTreeLazy(SSPTree& tree, MinPriorityQ& minQ) const {
+   tree.reset(names.size(), true);
+   tree.reach(tree.source, 0, -1);
+   minQ.insert(tree.source, 0);
+   for(int u = minQ.extractMin(); u != -1; u = minQ.extractMin()) {
+      for(int i = offsets[u]; i < offsets[u + 1]; i++) {
+         int v = targets[i];
+         int distance = tree.key[u] + weights[i];
+         int known = tree.distance(v);
+         if(known == INT_MAX) {
+            tree.reach(v, distance, u);
+            minQ.insert(v, distance);
+         } else if(distance < known) {
+            tree.reach(v, distance, u);
+            minQ.decreaseKey(v, distance);
+         }
+      }
+   }
+}
+
+/*
+ * @brief Dijkstra's algorithm with a monotone queue, such as BucketQ
+ * or RadixHeap
+ *
+ * @param tree the tree to fill in, with its source set
+ * @param frontier an empty queue whose keys may only go up
+ *
+ * @return nothing
+ *
+ * Vertices go in the queue when an edge first reaches them, and
+ * again each time their key drops, rather than having their key
+ * decreased. A copy that comes out with a key above the vertex's is
+ * stale and skipped; the one with the vertex's key is the only one
+ * left, since a vertex is only inserted again with a smaller key.
+ * Resets the tree lazily if setLazyReset says to.
+ */
+template <class Monotone>
+void Graph::buildSSPTree(SSPTree& tree, Monotone& frontier) const {
+   tree.reset(names.size(), lazyReset);
+   tree.reach(tree.source, 0, -1);
+   frontier.insert(tree.source, 0);
+   int distance;
+   for(int u = frontier.extractMin(distance); u != -1; u = frontier.extractMin(distance)) {
+      if(distance != tree.key[u]) {
+         continue;
+      }
+      for(int i = offsets[u]; i < offsets[u + 1]; i++) {
+         int v = targets[i];
+         if(tree.distance(v) > distance + weights[i]) {
+            tree.reach(v, distance + weights[i], u);
+            frontier.insert(v, distance + weights[i]);
+         }
       }
    }
 }
@@ -129,10 +857,12 @@ void Graph::buildSSPTree(string source) { //Dijkstra
  * @brief Calculates the weight of the edge as the path
  * from a source lengthens
  *
- * @param u a string containing the name of the vertex that is
- * the starting point of the particular edge being looked at
- * @param v a string containing the name of the vertex that is
- * the ending point of the particular edge being looked at
+ * @param tree the shortest path tree being built
+ * @param minQ the queue the tree's vertices are in
+ * @param u the number of the vertex that is the starting point of
+ * the particular edge being looked at
+ * @param v the number of the vertex that is the ending point of the
+ * particular edge being looked at
  * @param weight an integer containing the weight from vertex
  * u to v
  *
@@ -145,10 +875,365 @@ void Graph::buildSSPTree(string source) { //Dijkstra
  * SSPTree. Finally decreases the key of vertex v so it ends
  * up in the right place in the min priority queue.
  */
-void Graph::relax(string u, string v, int weight) {
-   if(vertices[v].key > (vertices[u].key + weight)) {
-      vertices[v].key = vertices[u].key + weight;
-      vertices[v].pi = u;
-      minQ.decreaseKey(v, vertices[v].key);
+void Graph::relax(SSPTree& tree, MinPriorityQ& minQ, int u, int v, int weight) {
+   vector<int>& key = tree.key;
+   if(key[v] > (key[u] + weight)) {
+      key[v] = key[u] + weight;
+      tree.pi[v] = u;
+      minQ.decreaseKey(v, key[v]);
+   }
+}
+
+/*
+ * @brief Runs Dijkstra's algorithm from a source until the target
+ * is settled
+ *
+ * @param forward the search to run
+ * @param source the number of the vertex to start at
+ * @param target the number of the vertex to stop at
+ *
+ * @return the distance to the target, or INT_MAX if it cannot be
+ * reached; forward.pi leads back from the target to the source
+ *
+ * Vertices only join the queue once an edge reaches them, so the
+ * search costs the part of the graph closer to the source than the
+ * target is, not the whole graph.
+ */
+int Graph::earlyExit(Search& forward, int source, int target) const {
+   startSearch(forward, source);
+   while(1) {
+      int u = forward.queue.extractMin();
+      if(u == -1) {
+         return INT_MAX;
+      }
+      if(u == target) {
+         return forward.key[target];
+      }
+      for(int i = offsets[u]; i < offsets[u + 1]; i++) {
+         reach(forward, targets[i], forward.key[u] + weights[i], u);
+      }
+   }
+}
+
+/*
+ * @brief Runs Dijkstra's algorithm forward from the source and
+ * backward from the target until the two searches meet
+ *
+ * @param workspace holds the two searches
+ * @param source the number of the vertex to start at
+ * @param target the number of the vertex to end at
+ * @param meet set to a vertex on the shortest path found
+ *
+ * @return the length of the shortest path, or INT_MAX if there is
+ * none; the forward search's pi leads from meet back to the source
+ * and the backward one's from meet on to the target
+ *
+ * Each step settles a vertex on the side whose next key is smaller.
+ * Every edge looked at that reaches a vertex the other side has a key
+ * for gives a path; the best one so far is kept. Once the two
+ * smallest keys add up to at least the best length, no shorter path
+ * is left to find.
+ */
+int Graph::bidirectional(Workspace& workspace, int source, int target, int& meet) const {
+   Search& forward = workspace.forward;
+   Search& backward = workspace.backward;
+   startSearch(forward, source);
+   startSearch(backward, target);
+   int best = INT_MAX;
+   meet = -1;
+   if(source == target) {
+      meet = source;
+      return 0;
+   }
+   while(1) {
+      int forwardMin = forward.queue.minKey();
+      int backwardMin = backward.queue.minKey();
+      if(forwardMin == INT_MAX || backwardMin == INT_MAX ||
+         (long long)forwardMin + backwardMin >= best) {
+         return best;
+      }
+      if(forwardMin <= backwardMin) {
+         settle(forward, backward, offsets, targets, weights, best, meet);
+      } else {
+         settle(backward, forward, reverseOffsets, sources, reverseWeights, best, meet);
+      }
+   }
+}
+
+/*
+ * @brief Settles the next vertex of one side of a bidirectional
+ * search
+ *
+ * @param side the search to take a step of
+ * @param other the search going the other way
+ * @param edgeOffsets, heads, edgeWeights the adjacency side searches
+ * over, in compressed sparse row form
+ * @param best the length of the best path found so far
+ * @param meet a vertex on that path
+ *
+ * @return nothing
+ */
+void Graph::settle(Search& side, const Search& other, const vector<int>& edgeOffsets,
+                   const vector<int>& heads, const vector<int>& edgeWeights,
+                   int& best, int& meet) {
+   int u = side.queue.extractMin();
+   for(int i = edgeOffsets[u]; i < edgeOffsets[u + 1]; i++) {
+      int v = heads[i];
+      int distance = side.key[u] + edgeWeights[i];
+      reach(side, v, distance, u);
+      if(other.key[v] != INT_MAX && (long long)distance + other.key[v] < best) {
+         best = distance + other.key[v];
+         meet = v;
+      }
+   }
+}
+
+/*
+ * @brief Resets one side of a point-to-point search and starts it
+ * at a vertex
+ *
+ * @param side the search to reset
+ * @param start the number of the vertex it starts at
+ *
+ * @return nothing
+ *
+ * Only the vertices the last search touched are reset, unless the
+ * graph has gained vertices since.
+ */
+void Graph::startSearch(Search& side, int start) const {
+   int vertexCount = names.size();
+   if((int)side.key.size() != vertexCount) {
+      side.key.assign(vertexCount, INT_MAX);
+      side.pi.assign(vertexCount, -1);
+   } else {
+      for(unsigned int i = 0; i < side.touched.size(); i++) {
+         side.key[side.touched[i]] = INT_MAX;
+         side.pi[side.touched[i]] = -1;
+      }
+   }
+   side.touched.clear();
+   side.queue.clear();
+   reach(side, start, 0, -1);
+}
+
+/*
+ * @brief Offers a vertex a new distance in a point-to-point search
+ *
+ * @param side the search
+ * @param v the number of the vertex reached
+ * @param distance the length of the path it was reached by
+ * @param previous the vertex before v on that path
+ * @param bound a lower bound on the distance from v to where the
+ * search is headed, 0 if there is none
+ *
+ * @return nothing
+ *
+ * Like relax, but puts v in the queue the first time it is reached.
+ * v is queued by its distance plus bound.
+ */
+void Graph::reach(Search& side, int v, int distance, int previous, int bound) {
+   int priority = (int)std::min((long long)distance + bound, (long long)INT_MAX);
+   if(side.key[v] == INT_MAX) {
+      side.touched.push_back(v);
+      side.key[v] = distance;
+      side.pi[v] = previous;
+      side.queue.insert(v, priority);
+   } else if(distance < side.key[v]) {
+      side.key[v] = distance;
+      side.pi[v] = previous;
+      side.queue.decreaseKey(v, priority);
+   }
+}
+
+/*
+ * @brief Runs A* from a source until the target is settled
+ *
+ * @param forward the search to run
+ * @param source the number of the vertex to start at
+ * @param target the number of the vertex to stop at
+ *
+ * @return the distance to the target, or INT_MAX if it cannot be
+ * reached; forward.pi leads back from the target to the source
+ *
+ * Like earlyExit, but each vertex is queued by its distance plus
+ * estimate's bound on the distance left, so vertices heading away
+ * from the target wait. Every heuristic is consistent, the bound
+ * dropping by no more than the weight along any edge, so each vertex
+ * is final when it is settled and the path found is a shortest one.
+ */
+int Graph::aStar(Search& forward, int source, int target) const {
+   startSearch(forward, source);
+   while(1) {
+      int u = forward.queue.extractMin();
+      if(u == -1) {
+         return INT_MAX;
+      }
+      if(u == target) {
+         return forward.key[target];
+      }
+      for(int i = offsets[u]; i < offsets[u + 1]; i++) {
+         int v = targets[i];
+         int distance = forward.key[u] + weights[i];
+         if(distance < forward.key[v]) {
+            reach(forward, v, distance, u, estimate(v, target));
+         }
+      }
+   }
+}
+
+/*
+ * @brief Bounds the distance between two vertices from below
+ *
+ * @param v the number of the vertex the distance is from
+ * @param target the number of the vertex it is to
+ *
+ * @return a distance no longer than the shortest path from v to
+ * target, or 0 if the heuristic has nothing to go on
+ *
+ * With landmarks, going through landmark l can only be as short as
+ * the triangle inequality allows: the path from v to target is at
+ * least d(l, target) - d(l, v) and at least d(v, l) - d(target, l).
+ * The best of these over the landmarks is the bound.
+ */
+int Graph::estimate(int v, int target) const {
+   if(heuristic == LANDMARKS) {
+      int bound = 0;
+      const int* at = &landmarkDistance[(size_t)v * landmarks * 2];
+      const int* goal = &landmarkDistance[(size_t)target * landmarks * 2];
+      for(int l = 0; l < 2 * landmarks; l += 2) {
+         if(at[l] != INT_MAX && goal[l] != INT_MAX) {
+            bound = std::max(bound, goal[l] - at[l]);
+         }
+         if(at[l + 1] != INT_MAX && goal[l + 1] != INT_MAX) {
+            bound = std::max(bound, at[l + 1] - goal[l + 1]);
+         }
+      }
+      return bound;
+   }
+   if(placedCount != (int)names.size()) {
+      return 0;
+   }
+   return (int)(scale * spacing(v, target));
+}
+
+/*
+ * @brief Gets the coordinate distance between two vertices
+ *
+ * @param u the number of one vertex
+ * @param v the number of the other vertex
+ *
+ * @return the straight line distance for EUCLIDEAN, the sum of the
+ * distances along each axis otherwise
+ */
+double Graph::spacing(int u, int v) const {
+   double dx = xs[u] - xs[v];
+   double dy = ys[u] - ys[v];
+   if(heuristic == EUCLIDEAN) {
+      return std::sqrt(dx * dx + dy * dy);
+   }
+   return std::fabs(dx) + std::fabs(dy);
+}
+
+/*
+ * @brief Works out what the heuristic needs if the graph or the
+ * heuristic has changed since the last time
+ *
+ * @return nothing
+ *
+ * For the geometric heuristics, finds the smallest weight per unit
+ * of distance over all the edges. Scaling the coordinate distance by
+ * it, a little less to be safe from rounding, and rounding down
+ * keeps every bound at most the weight of any path, since no edge is
+ * shorter than its scaled length.
+ */
+void Graph::prepareHeuristic() {
+   if(heuristicReady) {
+      return;
+   }
+   if(heuristic == LANDMARKS) {
+      chooseLandmarks();
+   } else if(placedCount == (int)names.size()) {
+      double smallest = HUGE_VAL;
+      for(int u = 0; u + 1 < (int)offsets.size(); u++) {
+         for(int i = offsets[u]; i < offsets[u + 1]; i++) {
+            double length = spacing(u, targets[i]);
+            if(length > 0) {
+               smallest = std::min(smallest, weights[i] / length);
+            }
+         }
+      }
+      scale = (smallest == HUGE_VAL || smallest < 0) ? 0 : smallest * (1 - 1e-9);
    }
-}
\ No newline at end of file
+   heuristicReady = true;
+}
+
+/*
+ * @brief Picks the landmarks and finds the distances to and from
+ * each of them
+ *
+ * @return nothing
+ *
+ * The first landmark is the vertex farthest from vertex 0, and each
+ * one after it is the vertex farthest from every landmark so far,
+ * which picks vertices around the outside of the graph where the
+ * bounds are tightest. A vertex no landmark reaches counts as
+ * farthest, so every part of a disconnected graph gets one.
+ */
+void Graph::chooseLandmarks() {
+   int vertexCount = names.size();
+   landmarks = std::min(landmarkCount, vertexCount);
+   landmarkDistance.assign((size_t)vertexCount * landmarks * 2, INT_MAX);
+   if(landmarks <= 0) {
+      landmarks = 0;
+      return;
+   }
+   buildReverse();
+   const Search& forward = scratch.forward;
+   distancesFrom(0, false);
+   int next = 0;
+   for(int v = 0; v < vertexCount; v++) {
+      if(forward.key[v] != INT_MAX && forward.key[v] > forward.key[next]) {
+         next = v;
+      }
+   }
+   vector<int> nearest(vertexCount, INT_MAX);
+   for(int l = 0; l < landmarks; l++) {
+      distancesFrom(next, false);
+      for(int v = 0; v < vertexCount; v++) {
+         landmarkDistance[((size_t)v * landmarks + l) * 2] = forward.key[v];
+         nearest[v] = std::min(nearest[v], forward.key[v]);
+      }
+      distancesFrom(next, true);
+      for(int v = 0; v < vertexCount; v++) {
+         landmarkDistance[((size_t)v * landmarks + l) * 2 + 1] = forward.key[v];
+      }
+      next = std::max_element(nearest.begin(), nearest.end()) - nearest.begin();
+   }
+}
+
+/*
+ * @brief Runs Dijkstra's algorithm from a vertex to every vertex it
+ * reaches
+ *
+ * @param start the number of the vertex to start at
+ * @param reverse whether to follow the edges backward, giving
+ * distances to start instead
+ *
+ * @return nothing; the distances are left in scratch.forward.key
+ */
+void Graph::distancesFrom(int start, bool reverse) {
+   Search& forward = scratch.forward;
+   const vector<int>& edgeOffsets = reverse ? reverseOffsets : offsets;
+   const vector<int>& heads = reverse ? sources : targets;
+   const vector<int>& edgeWeights = reverse ? reverseWeights : weights;
+   startSearch(forward, start);
+   while(1) {
+      int u = forward.queue.extractMin();
+      if(u == -1) {
+         return;
+      }
+      for(int i = edgeOffsets[u]; i < edgeOffsets[u + 1]; i++) {
+         reach(forward, heads[i], forward.key[u] + edgeWeights[i], u);
+      }
+   }
+}
@@ -10,43 +10,228 @@
  * https://en.wikipedia.org/wiki/Dijkstra%27s_algorithm
  */
 
+#ifndef CSCI_311_GRAPH_H
+#define CSCI_311_GRAPH_H
+
 #include <vector>
-#include <map>
+#include <unordered_map>
+#include <list>
 #include <string>
 #include <sstream>
-#include <list>
 #include <algorithm>
+#include <cmath>
 #include "minpriority.h"
+#include "bucketq.h"
+#include "radixheap.h"
+#include "hierarchy.h"
 
 using std::string;
-using std::map;
 using std::vector;
 
 class Graph {
    public:
-      void addVertex(string name);
-      void addEdge(string from, string to, int weight);
-      string getShortestPath(string from, string to);
+      // bytes of shortest path trees kept by default
+      static const size_t DEFAULT_CACHE_BYTES = 64 << 20;
+
+      // How getShortestPath searches: a whole shortest path tree from
+      // the source, which is cached; Dijkstra from the source stopping
+      // at the target; Dijkstra from both ends until they meet; A*
+      // from the source, steered by the heuristic; or the two upward
+      // searches of a contraction hierarchy, built when first needed.
+      enum Mode { TREE, EARLY_EXIT, BIDIRECTIONAL, ASTAR, CONTRACTED };
+
+      // Lower bounds on the distance left that A* steers by: the
+      // straight line or grid distance between vertex coordinates,
+      // scaled so no edge is shorter than its bound, or distances to
+      // and from a few landmark vertices. All of them keep the paths
+      // found exact.
+      enum Heuristic { EUCLIDEAN, MANHATTAN, LANDMARKS };
+
+      // landmarks chosen for the LANDMARKS heuristic by default
+      static const int DEFAULT_LANDMARKS = 8;
+
+      // The queue TREE mode builds trees with: the binary heap, Dial's
+      // buckets, one per weight up to the heaviest edge, or a radix
+      // heap. The last two only take each vertex out at its final
+      // distance and are only used when no weight is negative;
+      // BUCKETS also needs the heaviest weight to be at most
+      // MAX_BUCKET_WEIGHT. Otherwise the binary heap is used.
+      enum Queue { BINARY_HEAP, BUCKETS, RADIX_HEAP };
+
+      static const int MAX_BUCKET_WEIGHT = 1 << 20;
+
+      Graph(size_t cacheBytes = DEFAULT_CACHE_BYTES);
+      void setCacheBudget(size_t bytes);
+      void setMode(Mode mode);
+      void setHeuristic(Heuristic heuristic, int landmarkCount = DEFAULT_LANDMARKS);
+      void setQueue(Queue queue);
+      void setLazyReset(bool lazy);
+      void reserve(int vertexCount, int edgeCount);
+      void addVertex(const string& name);
+      void addVertex(const string& name, double x, double y);
+      void addEdge(const string& from, const string& to, int weight);
+      void finalize();
+      void prepare();
+      void buildHierarchy();
+      bool saveHierarchy(const string& path);
+      bool loadHierarchy(const string& path);
+      string getShortestPath(const string& from, const string& to);
 
    private:
-      class Vertex {
+      class Edge {
          public:
-            string pi;
-            int key;
+            int from;
+            int to;
+            int weight;
       };
-      
-      class Neighbor {
+
+      // Shortest path tree from one source. A tree built with lazy
+      // reset only owns key[v] and pi[v] where stamp[v] is epoch; the
+      // rest are left over from an earlier tree, and those vertices
+      // are unreached. Read it through distance and previous.
+      class SSPTree {
          public:
-            string name;
-            int weight;
+            SSPTree();
+            int source;
+            vector<int> key;             // distance, INT_MAX if unreached
+            vector<int> pi;              // predecessor, -1 for none
+            vector<unsigned int> stamp;  // empty unless built lazily
+            unsigned int epoch;          // the stamp of this tree's entries
+
+            void reset(int vertexCount, bool lazy);
+            void reach(int v, int distance, int previous);
+            int distance(int v) const;
+            int previous(int v) const;
+      };
+
+      // One side of a point-to-point search. key and pi are INT_MAX
+      // and -1 except at the vertices in touched, so a search only
+      // resets what the last one reached.
+      class Search {
+         public:
+            vector<int> key;             // distance from the start
+            vector<int> pi;              // previous vertex, -1 for none
+            vector<int> touched;         // vertices given a key
+            MinPriorityQ queue;          // reached but not settled
       };
 
-      void buildSSPTree(string source);
-      void relax(string u, string v, int weight);
-      string currentSource;
-      map<string, Vertex> vertices;
-      map<string, vector<Neighbor> > adjList;
-      MinPriorityQ minQ;
+   public:
+      // Everything one search writes to. The graph itself is only read
+      // while it answers a query in a workspace, so once prepare has
+      // run, threads can each query it at once with their own.
+      class Workspace {
+         public:
+            Workspace();
+         private:
+            friend class Graph;
+            SSPTree tree;                // TREE mode's last tree
+            unsigned long treeVersion;   // the graph's version when it was built
+            MinPriorityQ minQ;
+            BucketQ buckets;
+            RadixHeap radix;
+            Search forward;
+            Search backward;
+            Hierarchy::Search upward;    // CONTRACTED mode's two sides
+            Hierarchy::Search downward;
+      };
+
+      string getShortestPath(const string& from, const string& to,
+                             Workspace& workspace) const;
+
+   private:
+      int vertexId(const string& name);
+      bool prepared() const;
+      int shortestPath(int source, int target, vector<int>& path,
+                       Workspace& workspace) const;
+      int treePath(const SSPTree& tree, int target, vector<int>& path) const;
+      string describe(const string& from, const string& to, const vector<int>& path,
+                      int length) const;
+      const SSPTree& shortestPathTree(int source);
+      size_t treeLimit();
+      void dropTrees();
+      void buildTree(SSPTree& tree, Workspace& workspace) const;
+      void buildSSPTree(SSPTree& tree, MinPriorityQ& minQ) const;
+      void buildSSPTreeLazy(SSPTree& tree, MinPriorityQ& minQ) const;
+      template <class Monotone>
+      void buildSSPTree(SSPTree& tree, Monotone& frontier) const;
+      static void relax(SSPTree& tree, MinPriorityQ& minQ, int u, int v, int weight);
+      int earlyExit(Search& forward, int source, int target) const;
+      int bidirectional(Workspace& workspace, int source, int target, int& meet) const;
+      static void settle(Search& side, const Search& other, const vector<int>& edgeOffsets,
+                         const vector<int>& heads, const vector<int>& edgeWeights,
+                         int& best, int& meet);
+      void startSearch(Search& side, int start) const;
+      static void reach(Search& side, int v, int distance, int previous, int bound = 0);
+      void buildReverse();
+      int aStar(Search& forward, int source, int target) const;
+      int estimate(int v, int target) const;
+      double spacing(int u, int v) const;
+      void prepareHeuristic();
+      void chooseLandmarks();
+      void distancesFrom(int start, bool reverse);
+      bool finalized;                    // no edges waiting in pending
+      size_t cacheBytes;                 // budget for the cached trees
+      Mode mode;
+      Heuristic heuristic;
+      Queue queue;
+      bool lazyReset;                    // trees are built with epoch stamps
+      int landmarkCount;                 // landmarks wanted
+      bool heuristicReady;               // scale or landmarks are up to date
+      unsigned long version;             // counts the times the edges were packed
+
+      // Vertices are numbered 0, 1, ... in the order they are added.
+      vector<string> names;              // vertex number -> name
+      std::unordered_map<string, int> ids;   // name -> vertex number
+
+      // edges added since the last finalize, in the order added
+      vector<Edge> pending;
+
+      // Compressed sparse row adjacency: the edges out of u are
+      // targets[i] with weights[i] for offsets[u] <= i < offsets[u + 1].
+      vector<int> offsets;
+      vector<int> targets;
+      vector<int> weights;
+      int lightest;                      // smallest weight, 0 if no edges
+      int heaviest;                      // largest weight, 0 if no edges
+
+      // The same edges by the vertex they lead to, for searching
+      // backward: the edges into v come from sources[i] with
+      // reverseWeights[i] for reverseOffsets[v] <= i <
+      // reverseOffsets[v + 1]. Built by the first bidirectional search
+      // after a finalize.
+      vector<int> reverseOffsets;
+      vector<int> sources;
+      vector<int> reverseWeights;
+
+      // Coordinates by vertex number, NaN for vertices given none. The
+      // geometric heuristics only steer once every vertex has them.
+      vector<double> xs;
+      vector<double> ys;
+      int placedCount;                   // vertices with coordinates
+
+      // The geometric bound is scale times the coordinate distance,
+      // scale being the smallest weight per unit of distance of any
+      // edge.
+      double scale;
+
+      // For each vertex v, the distance from and then to each chosen
+      // landmark l at landmarkDistance[(v * landmarks + l) * 2] and
+      // the slot after it, INT_MAX where there is no path; kept
+      // together so a bound reads one vertex's block.
+      int landmarks;                     // landmarks chosen
+      vector<int> landmarkDistance;
+
+      // shortcuts for CONTRACTED mode; cleared whenever the graph changes
+      Hierarchy hierarchy;
+
+      // Trees built so far, most recently used first, and where each
+      // source's tree is in that list. Emptied whenever the graph
+      // changes.
+      std::list<SSPTree> trees;
+      std::unordered_map<int, std::list<SSPTree>::iterator> treeIndex;
+
+      // what the queries made without a workspace of their own search in
+      Workspace scratch;
+};
 
-      
-};
\ No newline at end of file
+#endif // CSCI_311_GRAPH_H
@@ -0,0 +1,682 @@
+/*
+ * @file hierarchy.cpp A contraction hierarchy over a graph's edges, so
+ * shortest paths can be found by two small searches that only climb.
+ *
+ * Vertices are contracted one at a time, least important first. Taking
+ * a vertex out of the graph adds a shortcut between two of its
+ * neighbours wherever the path through it was the only shortest one,
+ * so distances between the vertices left never change. A query then
+ * searches from the source only toward vertices contracted later, and
+ * from the target the same way over reversed arcs; the shortest path
+ * goes up to its latest contracted vertex and back down, so the two
+ * searches meet there.
+ *
+ * Resources:
+ * https://en.wikipedia.org/wiki/Contraction_hierarchies
+ */
+
+#include "hierarchy.h"
+#include <queue>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <functional>
+
+// first bytes of a saved hierarchy, with the format version
+static const char MAGIC[8] = {'s', 's', 'p', 'c', 'h', ' ', '1', '\n'};
+
+/*
+ * @brief Writes a vector to a file, its size first
+ *
+ * @param file the open file
+ * @param data the vector to write
+ *
+ * @return true if everything was written
+ */
+template <class T>
+static bool writeVector(FILE* file, const vector<T>& data) {
+   uint64_t size = data.size();
+   return fwrite(&size, sizeof(size), 1, file) == 1 &&
+          (size == 0 || fwrite(data.data(), sizeof(T), size, file) == size);
+}
+
+/*
+ * @brief Reads a vector written by writeVector
+ *
+ * @param file the open file
+ * @param data the vector to fill
+ * @param fileSize the size of the file, which no vector in it can be
+ * bigger than
+ *
+ * @return true if the whole vector was read
+ */
+template <class T>
+static bool readVector(FILE* file, vector<T>& data, long fileSize) {
+   uint64_t size;
+   if(fread(&size, sizeof(size), 1, file) != 1 || size > (uint64_t)fileSize / sizeof(T)) {
+      return false;
+   }
+   data.resize(size);
+   return size == 0 || fread(data.data(), sizeof(T), size, file) == size;
+}
+
+/*
+ * @brief Default constructor
+ *
+ * Starts with no hierarchy built.
+ */
+Hierarchy::Hierarchy() : ready(false), graphPrint(0), goalMark(0) {}
+
+/*
+ * @brief Contracts a graph into a hierarchy
+ *
+ * @param offsets where each vertex's edges start in targets and
+ * weights, with one more entry for the end
+ * @param targets the vertex each edge leads to
+ * @param weights the weight of each edge
+ *
+ * @return nothing
+ *
+ * Vertices are contracted in order of importance. Contracting a
+ * vertex raises its neighbours' importance by the neighbours now gone
+ * and how deep the contracted vertices around them go, which is
+ * added to their queued importance straight away. The shortcuts they
+ * need may change too, so the least important vertex is weighed again
+ * in full before it is contracted, and put back if it has fallen
+ * behind the next one. Entries left behind with an old importance
+ * are skipped.
+ */
+void Hierarchy::build(const vector<int>& offsets, const vector<int>& targets,
+                      const vector<int>& weights) {
+   clear();
+   int vertexCount = offsets.empty() ? 0 : offsets.size() - 1;
+   graphPrint = fingerprint(offsets, targets, weights);
+   out.assign(vertexCount, vector<Arc>());
+   in.assign(vertexCount, vector<Arc>());
+   contracted.assign(vertexCount, 0);
+   neighboursGone.assign(vertexCount, 0);
+   level.assign(vertexCount, 0);
+   goal.assign(vertexCount, 0);
+   goalMark = 0;
+   through.assign(vertexCount, 0);
+   hops.assign(vertexCount, 0);
+   for(int u = 0; u < vertexCount; u++) {
+      for(int i = offsets[u]; i < offsets[u + 1]; i++) {
+         if(targets[i] != u) {
+            addArc(u, targets[i], weights[i], -1);
+         }
+      }
+   }
+
+   typedef std::pair<int, int> Entry;   // priority, vertex
+   std::priority_queue<Entry, vector<Entry>, std::greater<Entry> > order;
+   vector<int> priority(vertexCount);   // importance last queued with
+   for(int v = 0; v < vertexCount; v++) {
+      priority[v] = importance(v);
+      order.push(Entry(priority[v], v));
+   }
+   vector<vector<Arc> > up(vertexCount);
+   vector<vector<Arc> > down(vertexCount);
+   rank.assign(vertexCount, -1);
+   int next = 0;
+   while(!order.empty()) {
+      int v = order.top().second;
+      int queued = order.top().first;
+      order.pop();
+      if(contracted[v] || queued != priority[v]) {
+         continue;
+      }
+      priority[v] = importance(v);
+      if(!order.empty() && priority[v] > order.top().first) {
+         order.push(Entry(priority[v], v));
+         continue;
+      }
+
+      rank[v] = next++;
+      up[v] = out[v];
+      down[v] = in[v];
+      contract(v, false);
+      contracted[v] = 1;
+      vector<int> neighbours;
+      for(int side = 0; side < 2; side++) {
+         vector<Arc>& arcs = (side == 0) ? out[v] : in[v];
+         for(unsigned int i = 0; i < arcs.size(); i++) {
+            int neighbour = arcs[i].head;
+            vector<Arc>& back = (side == 0) ? in[neighbour] : out[neighbour];
+            back.erase(std::remove_if(back.begin(), back.end(),
+                                      [v](const Arc& arc) {return (arc.head == v);}),
+                       back.end());
+            int before = neighboursGone[neighbour] + level[neighbour];
+            neighboursGone[neighbour]++;
+            level[neighbour] = std::max(level[neighbour], level[v] + 1);
+            priority[neighbour] += neighboursGone[neighbour] + level[neighbour] - before;
+            neighbours.push_back(neighbour);
+         }
+      }
+      vector<Arc>().swap(out[v]);
+      vector<Arc>().swap(in[v]);
+      std::sort(neighbours.begin(), neighbours.end());
+      neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+      for(unsigned int i = 0; i < neighbours.size(); i++) {
+         order.push(Entry(priority[neighbours[i]], neighbours[i]));
+      }
+   }
+
+   upOffsets.assign(vertexCount + 1, 0);
+   downOffsets.assign(vertexCount + 1, 0);
+   for(int v = 0; v < vertexCount; v++) {
+      upOffsets[v + 1] = upOffsets[v] + up[v].size();
+      downOffsets[v + 1] = downOffsets[v] + down[v].size();
+      upArcs.insert(upArcs.end(), up[v].begin(), up[v].end());
+      downArcs.insert(downArcs.end(), down[v].begin(), down[v].end());
+   }
+   vector<vector<Arc> >().swap(out);
+   vector<vector<Arc> >().swap(in);
+   vector<char>().swap(contracted);
+   vector<int>().swap(neighboursGone);
+   vector<int>().swap(level);
+   vector<int>().swap(goal);
+   vector<int>().swap(through);
+   vector<int>().swap(hops);
+   ready = true;
+}
+
+/*
+ * @brief Writes the hierarchy to a file
+ *
+ * @param path the name of the file
+ *
+ * @return true if the hierarchy was written
+ *
+ * Writes a temporary file and renames it over path, so a crash never
+ * leaves half a hierarchy behind. The file holds the fingerprint of
+ * the graph it was built from and is only meant to be read back on
+ * the same kind of machine.
+ */
+bool Hierarchy::save(const string& path) {
+   if(!ready) {
+      return false;
+   }
+   string tempPath = path + ".tmp";
+   FILE* file = fopen(tempPath.c_str(), "wb");
+   if(file == nullptr) {
+      return false;
+   }
+   bool written = fwrite(MAGIC, 1, sizeof(MAGIC), file) == sizeof(MAGIC) &&
+                  fwrite(&graphPrint, sizeof(graphPrint), 1, file) == 1 &&
+                  writeVector(file, rank) &&
+                  writeVector(file, upOffsets) && writeVector(file, upArcs) &&
+                  writeVector(file, downOffsets) && writeVector(file, downArcs);
+   written = (fclose(file) == 0) && written;
+   if(!written || rename(tempPath.c_str(), path.c_str()) != 0) {
+      remove(tempPath.c_str());
+      return false;
+   }
+   return true;
+}
+
+/*
+ * @brief Reads a hierarchy written by save
+ *
+ * @param path the name of the file
+ * @param fingerprint the fingerprint of the graph the hierarchy is
+ * wanted for
+ *
+ * @return true if the file held a hierarchy of that graph; otherwise
+ * nothing is loaded
+ *
+ * Checks that every offset and arc stays in bounds, that rank orders
+ * the vertices, that every arc climbs, and that each shortcut's
+ * middle vertex ranks below both ends and holds the two arcs it
+ * stands for, so a damaged file cannot send a query out of bounds or
+ * into endless unpacking.
+ */
+bool Hierarchy::load(const string& path, uint64_t fingerprint) {
+   clear();
+   FILE* file = fopen(path.c_str(), "rb");
+   if(file == nullptr) {
+      return false;
+   }
+   fseek(file, 0, SEEK_END);
+   long fileSize = ftell(file);
+   rewind(file);
+   char magic[sizeof(MAGIC)];
+   bool read = fread(magic, 1, sizeof(magic), file) == sizeof(magic) &&
+               memcmp(magic, MAGIC, sizeof(MAGIC)) == 0 &&
+               fread(&graphPrint, sizeof(graphPrint), 1, file) == 1 &&
+               graphPrint == fingerprint &&
+               readVector(file, rank, fileSize) &&
+               readVector(file, upOffsets, fileSize) && readVector(file, upArcs, fileSize) &&
+               readVector(file, downOffsets, fileSize) && readVector(file, downArcs, fileSize);
+   fclose(file);
+
+   int vertexCount = rank.size();
+   read = read && (int)upOffsets.size() == vertexCount + 1 &&
+          (int)downOffsets.size() == vertexCount + 1 &&
+          upOffsets[0] == 0 && downOffsets[0] == 0 &&
+          upOffsets[vertexCount] == (int)upArcs.size() &&
+          downOffsets[vertexCount] == (int)downArcs.size();
+   vector<char> ranked(read ? vertexCount : 0, 0);
+   for(int v = 0; read && v < vertexCount; v++) {
+      read = rank[v] >= 0 && rank[v] < vertexCount && !ranked[rank[v]] &&
+             upOffsets[v] <= upOffsets[v + 1] && downOffsets[v] <= downOffsets[v + 1];
+      if(read) {
+         ranked[rank[v]] = 1;
+      }
+   }
+   for(int side = 0; read && side < 2; side++) {
+      const vector<int>& offsets = (side == 0) ? upOffsets : downOffsets;
+      const vector<Arc>& arcs = (side == 0) ? upArcs : downArcs;
+      for(int v = 0; read && v < vertexCount; v++) {
+         for(int i = offsets[v]; read && i < offsets[v + 1]; i++) {
+            int head = arcs[i].head;
+            int middle = arcs[i].middle;
+            read = head >= 0 && head < vertexCount && rank[head] > rank[v] &&
+                   middle >= -1 && middle < vertexCount;
+            if(read && middle != -1) {
+               int from = (side == 0) ? v : head;
+               int to = (side == 0) ? head : v;
+               read = rank[middle] < rank[v] &&
+                      findArc(downOffsets, downArcs, middle, from) != -1 &&
+                      findArc(upOffsets, upArcs, middle, to) != -1;
+            }
+         }
+      }
+   }
+   if(!read) {
+      clear();
+      return false;
+   }
+   ready = true;
+   return true;
+}
+
+/*
+ * @brief Forgets the hierarchy
+ *
+ * @return nothing
+ */
+void Hierarchy::clear() {
+   ready = false;
+   rank.clear();
+   upOffsets.clear();
+   upArcs.clear();
+   downOffsets.clear();
+   downArcs.clear();
+}
+
+/*
+ * @brief Tells whether there is a hierarchy to query
+ *
+ * @return true after build or a successful load, until clear
+ */
+bool Hierarchy::built() const {
+   return ready;
+}
+
+/*
+ * @brief Finds a shortest path through the hierarchy
+ *
+ * @param source the number of the vertex the path starts at
+ * @param target the number of the vertex the path ends at
+ * @param path filled with the vertex numbers along the path in the
+ * graph, shortcuts unpacked, from source to target
+ * @param forward, backward scratch for the two sides of the search
+ *
+ * @return the length of the path, or INT_MAX if there is none
+ *
+ * Searches up from the source and up the reversed arcs from the
+ * target, each side stepping while its next key is below the best
+ * path found where they touch.
+ */
+int Hierarchy::query(int source, int target, vector<int>& path, Search& forward,
+                     Search& backward) const {
+   path.clear();
+   if(source == target) {
+      path.push_back(source);
+      return 0;
+   }
+   int vertexCount = rank.size();
+   start(forward, source, vertexCount);
+   start(backward, target, vertexCount);
+   int best = INT_MAX;
+   int meet = -1;
+   while(1) {
+      int forwardMin = forward.queue.minKey();
+      int backwardMin = backward.queue.minKey();
+      bool forwardOn = forwardMin < best;
+      bool backwardOn = backwardMin < best;
+      if(!forwardOn && !backwardOn) {
+         break;
+      }
+      if(forwardOn && (!backwardOn || forwardMin <= backwardMin)) {
+         settle(forward, backward, upOffsets, upArcs, downOffsets, downArcs, best, meet);
+      } else {
+         settle(backward, forward, downOffsets, downArcs, upOffsets, upArcs, best, meet);
+      }
+   }
+   if(best == INT_MAX) {
+      return INT_MAX;
+   }
+
+   vector<int> climb;
+   for(int v = meet; v != source; v = forward.pi[v]) {
+      climb.push_back(v);
+   }
+   path.push_back(source);
+   for(vector<int>::reverse_iterator it = climb.rbegin(); it != climb.rend(); it++) {
+      unpack(forward.pi[*it], *it, upArcs[forward.via[*it]].middle, path);
+   }
+   for(int v = meet; v != target; v = backward.pi[v]) {
+      unpack(v, backward.pi[v], downArcs[backward.via[v]].middle, path);
+   }
+   return best;
+}
+
+/*
+ * @brief Computes a fingerprint of a graph's edges
+ *
+ * @param offsets, targets, weights the edges in compressed sparse row
+ * form
+ *
+ * @return a 64-bit FNV-1a hash of the three arrays
+ */
+uint64_t Hierarchy::fingerprint(const vector<int>& offsets, const vector<int>& targets,
+                                const vector<int>& weights) {
+   uint64_t hash = 14695981039346656037ULL;
+   const vector<int>* arrays[] = {&offsets, &targets, &weights};
+   for(int a = 0; a < 3; a++) {
+      hash = (hash ^ arrays[a]->size()) * 1099511628211ULL;
+      for(unsigned int i = 0; i < arrays[a]->size(); i++) {
+         hash = (hash ^ (uint32_t)(*arrays[a])[i]) * 1099511628211ULL;
+      }
+   }
+   return hash;
+}
+
+/*
+ * @brief Weighs up how soon a vertex should be contracted
+ *
+ * @param v the number of the vertex
+ *
+ * @return the importance of v; the least important goes first
+ *
+ * Twice the arcs contracting v would add less those it would take
+ * away, so the graph left stays sparse, plus how many neighbours of
+ * v are gone and how deep the contracted vertices around v already
+ * go, which spreads the contraction evenly over the graph and keeps
+ * the hierarchy shallow.
+ */
+int Hierarchy::importance(int v) {
+   int arcs = out[v].size() + in[v].size();
+   return 2 * (contract(v, true) - arcs) + neighboursGone[v] + level[v];
+}
+
+/*
+ * @brief Takes a vertex out of the graph being contracted
+ *
+ * @param v the number of the vertex
+ * @param simulate if true only count the shortcuts
+ *
+ * @return the number of shortcuts contracting v needs
+ *
+ * For each arc u -> v, searches from u without going through v for
+ * paths to the vertices v leads to. Where none is as short as going
+ * through v, a shortcut u -> x through v is needed. A search that
+ * gives up early only costs an extra shortcut, never a wrong path.
+ */
+int Hierarchy::contract(int v, bool simulate) {
+   int shortcuts = 0;
+   for(unsigned int i = 0; i < in[v].size(); i++) {
+      int u = in[v][i].head;
+      int limit = -1;
+      int goals = 0;
+      goalMark++;
+      for(unsigned int j = 0; j < out[v].size(); j++) {
+         int x = out[v][j].head;
+         if(x != u) {
+            through[x] = in[v][i].weight + out[v][j].weight;
+            limit = std::max(limit, through[x]);
+            goal[x] = goalMark;
+            goals++;
+         }
+      }
+      if(goals == 0) {
+         continue;
+      }
+      if(simulate) {
+         witnessSearch(u, v, limit, goals, SIMULATE_LIMIT, SIMULATE_HOPS);
+      } else {
+         witnessSearch(u, v, limit, goals, WITNESS_LIMIT, WITNESS_HOPS);
+      }
+      for(unsigned int j = 0; j < out[v].size(); j++) {
+         int x = out[v][j].head;
+         if(x != u && witness.key[x] > through[x]) {
+            shortcuts++;
+            if(!simulate) {
+               addArc(u, x, through[x], v);
+            }
+         }
+      }
+   }
+   return shortcuts;
+}
+
+/*
+ * @brief Adds an arc to the graph being contracted
+ *
+ * @param from the number of the vertex the arc leaves
+ * @param to the number of the vertex the arc enters
+ * @param weight the length of the arc
+ * @param middle the vertex a shortcut goes through, -1 for an edge
+ *
+ * @return nothing
+ *
+ * Only the shortest arc between two vertices is kept.
+ */
+void Hierarchy::addArc(int from, int to, int weight, int middle) {
+   for(unsigned int i = 0; i < out[from].size(); i++) {
+      if(out[from][i].head == to) {
+         if(weight < out[from][i].weight) {
+            out[from][i].weight = weight;
+            out[from][i].middle = middle;
+            for(unsigned int j = 0; j < in[to].size(); j++) {
+               if(in[to][j].head == from) {
+                  in[to][j].weight = weight;
+                  in[to][j].middle = middle;
+               }
+            }
+         }
+         return;
+      }
+   }
+   Arc arc;
+   arc.head = to;
+   arc.weight = weight;
+   arc.middle = middle;
+   out[from].push_back(arc);
+   arc.head = from;
+   in[to].push_back(arc);
+}
+
+/*
+ * @brief Runs Dijkstra's algorithm from a vertex around another one
+ *
+ * @param from the number of the vertex to search from
+ * @param skip the number of the vertex to keep out of the paths
+ * @param limit the distance past which paths are of no use
+ * @param goals how many vertices are marked in goal
+ * @param settleLimit how many vertices to settle at most
+ * @param hopLimit how many arcs long a path may grow
+ *
+ * @return nothing; distances found are left in witness.key
+ *
+ * Stops once every goal has been reached by a path no longer than
+ * through it, at limit, or at settleLimit; the path need not be the
+ * shortest to make a shortcut unneeded. Paths are not followed past
+ * hopLimit arcs, which keeps the search small where the graph left
+ * has grown dense.
+ */
+void Hierarchy::witnessSearch(int from, int skip, int limit, int goals, int settleLimit,
+                              int hopLimit) {
+   start(witness, from, out.size());
+   hops[from] = 0;
+   int settled = 0;
+   while(goals > 0 && witness.queue.minKey() <= limit && settled++ < settleLimit) {
+      int u = witness.queue.extractMin();
+      if(hops[u] == hopLimit) {
+         continue;
+      }
+      for(unsigned int i = 0; i < out[u].size(); i++) {
+         int x = out[u][i].head;
+         int distance = witness.key[u] + out[u][i].weight;
+         if(x == skip || distance >= witness.key[x]) {
+            continue;
+         }
+         if(goal[x] == goalMark && witness.key[x] > through[x] && distance <= through[x]) {
+            goals--;
+         }
+         reach(witness, x, distance, u, -1);
+         hops[x] = hops[u] + 1;
+      }
+   }
+}
+
+/*
+ * @brief Resets a search and starts it at a vertex
+ *
+ * @param side the search to reset
+ * @param vertex the number of the vertex it starts at
+ * @param vertexCount the number of vertices in the graph
+ *
+ * @return nothing
+ *
+ * Only the vertices the last search touched are reset.
+ */
+void Hierarchy::start(Search& side, int vertex, int vertexCount) {
+   if((int)side.key.size() != vertexCount) {
+      side.key.assign(vertexCount, INT_MAX);
+      side.pi.assign(vertexCount, -1);
+      side.via.assign(vertexCount, -1);
+   } else {
+      for(unsigned int i = 0; i < side.touched.size(); i++) {
+         side.key[side.touched[i]] = INT_MAX;
+         side.pi[side.touched[i]] = -1;
+         side.via[side.touched[i]] = -1;
+      }
+   }
+   side.touched.clear();
+   side.queue.clear();
+   reach(side, vertex, 0, -1, -1);
+}
+
+/*
+ * @brief Settles the next vertex of one side of a query
+ *
+ * @param side the search to take a step of
+ * @param other the search going the other way
+ * @param offsets, arcs the arcs side climbs, in compressed sparse
+ * row form
+ * @param stallOffsets, stallArcs the arcs climbing the other way
+ * @param best the length of the best path found so far
+ * @param meet the vertex where that path turns from climbing from
+ * the source to climbing from the target
+ *
+ * @return nothing
+ *
+ * Stalls on demand: if a vertex side has already reached further up
+ * has an arc down to u that is shorter than u's key, u's key is not
+ * its distance and no shortest path climbs through u, so its arcs
+ * are not followed.
+ */
+void Hierarchy::settle(Search& side, const Search& other, const vector<int>& offsets,
+                       const vector<Arc>& arcs, const vector<int>& stallOffsets,
+                       const vector<Arc>& stallArcs, int& best, int& meet) {
+   int u = side.queue.extractMin();
+   for(int i = stallOffsets[u]; i < stallOffsets[u + 1]; i++) {
+      int above = side.key[stallArcs[i].head];
+      if(above != INT_MAX && above + stallArcs[i].weight < side.key[u]) {
+         return;
+      }
+   }
+   for(int i = offsets[u]; i < offsets[u + 1]; i++) {
+      int v = arcs[i].head;
+      int distance = side.key[u] + arcs[i].weight;
+      reach(side, v, distance, u, i);
+      if(other.key[v] != INT_MAX && side.key[v] == distance &&
+         (long long)distance + other.key[v] < best) {
+         best = distance + other.key[v];
+         meet = v;
+      }
+   }
+}
+
+/*
+ * @brief Offers a vertex a new distance in a search
+ *
+ * @param side the search
+ * @param v the number of the vertex reached
+ * @param distance the length of the path it was reached by
+ * @param previous the vertex before v on that path
+ * @param arc the arc from previous to v
+ *
+ * @return nothing
+ */
+void Hierarchy::reach(Search& side, int v, int distance, int previous, int arc) {
+   if(side.key[v] == INT_MAX) {
+      side.touched.push_back(v);
+      side.queue.insert(v, distance);
+   } else if(distance < side.key[v]) {
+      side.queue.decreaseKey(v, distance);
+   } else {
+      return;
+   }
+   side.key[v] = distance;
+   side.pi[v] = previous;
+   side.via[v] = arc;
+}
+
+/*
+ * @brief Appends the vertices an arc stands for to a path
+ *
+ * @param from the number of the vertex the arc leaves, already on
+ * the path
+ * @param to the number of the vertex the arc enters
+ * @param middle the vertex the arc is a shortcut through, -1 for an
+ * edge of the graph
+ * @param path the path to add to
+ *
+ * @return nothing
+ *
+ * A shortcut's middle vertex was contracted before both its ends, so
+ * the two arcs it replaced are stored at middle: from -> middle with
+ * the arcs into it, middle -> to with the arcs out of it.
+ */
+void Hierarchy::unpack(int from, int to, int middle, vector<int>& path) const {
+   if(middle == -1) {
+      path.push_back(to);
+      return;
+   }
+   unpack(from, middle, downArcs[findArc(downOffsets, downArcs, middle, from)].middle, path);
+   unpack(middle, to, upArcs[findArc(upOffsets, upArcs, middle, to)].middle, path);
+}
+
+/*
+ * @brief Finds the arc between a vertex and another one
+ *
+ * @param offsets, arcs the arcs to look in
+ * @param at the number of the vertex the arcs are stored at
+ * @param head the number of the vertex at the other end
+ *
+ * @return the index of the arc in arcs, or -1 if there is none; load
+ * makes sure unpack never asks for one that is missing
+ */
+int Hierarchy::findArc(const vector<int>& offsets, const vector<Arc>& arcs, int at,
+                       int head) const {
+   for(int i = offsets[at]; i < offsets[at + 1]; i++) {
+      if(arcs[i].head == head) {
+         return i;
+      }
+   }
+   return -1;
+}
@@ -0,0 +1,114 @@
+/*
+ * @file hierarchy.h A contraction hierarchy over a graph's edges, so
+ * shortest paths can be found by two small searches that only climb.
+ *
+ * Resources:
+ * https://en.wikipedia.org/wiki/Contraction_hierarchies
+ */
+
+#ifndef CSCI_311_HIERARCHY_H
+#define CSCI_311_HIERARCHY_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "minpriority.h"
+
+using std::string;
+using std::vector;
+
+class Hierarchy {
+   public:
+      Hierarchy();
+      void build(const vector<int>& offsets, const vector<int>& targets,
+                 const vector<int>& weights);
+      bool save(const string& path);
+      bool load(const string& path, uint64_t fingerprint);
+      void clear();
+      bool built() const;
+
+      // One side of a query; key and pi are INT_MAX and -1 except at
+      // the vertices in touched. Queries take theirs from the caller,
+      // so threads can query one hierarchy at once.
+      class Search {
+         public:
+            vector<int> key;             // distance from the start
+            vector<int> pi;              // previous vertex, -1 for none
+            vector<int> via;             // arc reached by, for unpacking
+            vector<int> touched;
+            MinPriorityQ queue;
+      };
+
+      int query(int source, int target, vector<int>& path, Search& forward,
+                Search& backward) const;
+
+      // identifies a graph's edges, to tell whether a saved hierarchy
+      // was built from them
+      static uint64_t fingerprint(const vector<int>& offsets, const vector<int>& targets,
+                                  const vector<int>& weights);
+
+   private:
+      // settled vertices after which a witness search gives up, when
+      // contracting and when only weighing up a contraction
+      static const int WITNESS_LIMIT = 200;
+      static const int SIMULATE_LIMIT = 50;
+      // arcs a witness path may have, likewise
+      static const int WITNESS_HOPS = 5;
+      static const int SIMULATE_HOPS = 3;
+
+      // An edge of the hierarchy: an edge of the graph when middle is
+      // -1, otherwise a shortcut for the path through middle, which
+      // was contracted before both ends.
+      class Arc {
+         public:
+            int head;
+            int weight;
+            int middle;
+      };
+
+      bool ready;                        // rank and arcs describe a graph
+      uint64_t graphPrint;               // fingerprint of that graph
+
+      // when each vertex was contracted, 0 first; the searches only
+      // climb to vertices of higher rank
+      vector<int> rank;
+
+      // Arcs up the hierarchy in compressed sparse row form: upArcs
+      // from upOffsets[v] hold the arcs out of v to vertices of higher
+      // rank; downArcs from downOffsets[v] hold the arcs into v from
+      // vertices of higher rank, head being the other end.
+      vector<int> upOffsets;
+      vector<Arc> upArcs;
+      vector<int> downOffsets;
+      vector<Arc> downArcs;
+
+      // the graph while it is being contracted
+      vector<vector<Arc> > out;
+      vector<vector<Arc> > in;
+      vector<char> contracted;
+      vector<int> neighboursGone;        // contracted neighbours
+      vector<int> level;                 // longest chain of contracted neighbours
+      Search witness;
+      // goal[x] == goalMark marks the vertices a witness search is
+      // looking for
+      vector<int> goal;
+      int goalMark;
+      vector<int> through;               // length via the vertex to each goal
+      vector<int> hops;                  // arcs on a witness search's paths
+
+      int importance(int v);
+      int contract(int v, bool simulate);
+      void addArc(int from, int to, int weight, int middle);
+      void witnessSearch(int from, int skip, int limit, int goals, int settleLimit,
+                         int hopLimit);
+      static void start(Search& side, int vertex, int vertexCount);
+      static void reach(Search& side, int v, int distance, int previous, int arc);
+      static void settle(Search& side, const Search& other, const vector<int>& offsets,
+                         const vector<Arc>& arcs, const vector<int>& stallOffsets,
+                         const vector<Arc>& stallArcs, int& best, int& meet);
+      void unpack(int from, int to, int middle, vector<int>& path) const;
+      int findArc(const vector<int>& offsets, const vector<Arc>& arcs, int at,
+                  int head) const;
+};
+
+#endif // CSCI_311_HIERARCHY_H
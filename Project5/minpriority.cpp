@@ -17,61 +17,63 @@ MinPriorityQ::MinPriorityQ(/*int size*/) {}
 /*
  * @brief Destructor
  *
- * Clears minHeap for memory reasons.
+ * Clears minHeap and the positions for memory reasons.
  */
 MinPriorityQ::~MinPriorityQ() {
    minHeap.clear();
+   position.clear();
 }
 
 /*
  * @brief Inserts a new Element to minHeap
  *
- * @param id a string containing data to be associated with a key
- * @param key an integer associated with a particular string id
+ * @param id a non-negative integer to be associated with a key, such
+ * as a vertex number
+ * @param key an integer associated with a particular id
  *
  * @return nothing
  *
  * Creates a new Element with the given id and INT_MAX for the key,
- * pushes the Element onto the end of minHeap, then calls decreaseKey
- * with the given key to adjust the key correctly and get the Element
- * into the right place within the minHeap.
+ * pushes the Element onto the end of minHeap and records its slot,
+ * then calls decreaseKey with the given key to adjust the key
+ * correctly and get the Element into the right place within the
+ * minHeap. The slot table grows to fit the largest id seen.
  */
-void MinPriorityQ::insert(string id, int key) {
-   Element* temp = new Element();
-   temp->id = id;
-   temp->key = INT_MAX;
+void MinPriorityQ::insert(int id, int key) {
+   Element temp;
+   temp.id = id;
+   temp.key = INT_MAX;
    minHeap.push_back(temp);
+   if(id >= (int)position.size()) {
+      position.resize(id + 1, -1);
+   }
+   position[id] = minHeap.size() - 1;
    decreaseKey(id, key);
 }
 
 /*
- * @brief Searches the minHeap for a given string and decreases the key
+ * @brief Finds a given id in the minHeap and decreases the key
  * to a new given value, then adjusts Element's placement in the heap
  *
- * @param id a string the heap is searched through for
+ * @param id an integer the heap is searched through for
  * @param newKey an integer of the new value of the key that goes with
  * the given id
  *
  * @return nothing
  *
- * Iterates through the minHeap searching for the given id, changes the
- * corrisponding key to a smaller value, then adjusts the heap to be in
- * the correct order.
+ * Looks up the slot of the given id, changes the corrisponding key to
+ * a smaller value, then moves the Element up until the heap is in the
+ * correct order again, in O(log n). Ids that are not in the heap are
+ * ignored.
  */
-void MinPriorityQ::decreaseKey(string id, int newKey) {
-   int index = 0;
-   for(std::vector<Element*>::iterator it = minHeap.begin();
-         it != minHeap.end(); it++) {
-      if((*it)->id == id) {
-         (*it)->key = newKey;
-         break;
-      }
-      index++;
+void MinPriorityQ::decreaseKey(int id, int newKey) {
+   if(!isMember(id)) {
+      return;
    }
-   while(index > 0 && minHeap[parent(index)]->key > minHeap[index]->key) {
-      Element* temp = minHeap[index];
-      minHeap[index] = minHeap[parent(index)];
-      minHeap[parent(index)] = temp;
+   int index = position[id];
+   minHeap[index].key = newKey;
+   while(index > 0 && minHeap[parent(index)].key > minHeap[index].key) {
+      swapElements(index, parent(index));
       index = parent(index);
    }
 }
@@ -79,42 +81,63 @@ void MinPriorityQ::decreaseKey(string id, int newKey) {
 /*
  * @brief Extracts the element with the smallest key
  *
- * @return the string id of the Element with the smallest key
+ * @return the id of the Element with the smallest key, or -1 if the
+ * heap is empty
  *
  * Takes the first Element, swaps it with the last Element, then pops
- * the last Element off to reduce the list size. Then calls minHeapify
- * to reorder the remaining Elements.
+ * the last Element off to reduce the list size and forgets its slot.
+ * Then calls minHeapify to reorder the remaining Elements.
  */
-string MinPriorityQ::extractMin() {
+int MinPriorityQ::extractMin() {
    if(minHeap.size() == 0) {
-      return "empty";
+      return -1;
    }
-   string min = minHeap[0]->id;
-   minHeap[0] = minHeap[minHeap.size() - 1];
+   swapElements(0, minHeap.size() - 1);
+   int min = minHeap.back().id;
+   position[min] = -1;
    minHeap.pop_back();
    minHeapify(0);
    return min;
 }
 
+/*
+ * @brief Looks at the smallest key without extracting it
+ *
+ * @return the smallest key in the heap, or INT_MAX if it is empty
+ */
+int MinPriorityQ::minKey() {
+   if(minHeap.size() == 0) {
+      return INT_MAX;
+   }
+   return minHeap[0].key;
+}
+
+/*
+ * @brief Removes every Element from the heap
+ *
+ * @return nothing
+ *
+ * Forgets the slot of each Element still in the heap, so it costs
+ * the size of the heap rather than of the slot table.
+ */
+void MinPriorityQ::clear() {
+   for(unsigned int i = 0; i < minHeap.size(); i++) {
+      position[minHeap[i].id] = -1;
+   }
+   minHeap.clear();
+}
+
 /*
  * @brief Searches the tree to see if a specific id is there
  *
- * @param id a string containing the desired data to be searched for
+ * @param id an integer containing the desired data to be searched for
  *
  * @return if id is found return true, otherwise return false
  *
- * Iterates through the vector minHeap, comparing each id to the given id.
- * If the end of the vector is reached without finding the given id, false
- * is returned.
+ * Every id in minHeap has a recorded slot, so this is one lookup.
  */
-bool MinPriorityQ::isMember(string id) {
-   for(std::vector<Element*>::iterator it = minHeap.begin();
-         it != minHeap.end(); it++) {
-      if((*it)->id == id) {
-         return true;
-      }
-   }
-   return false;
+bool MinPriorityQ::isMember(int id) {
+   return id >= 0 && id < (int)position.size() && position[id] >= 0;
 }
 
 /*
@@ -127,9 +150,7 @@ bool MinPriorityQ::isMember(string id) {
  */
 void MinPriorityQ::buildMinHeap() {
    for(int i = minHeap.size()/2; i >= 1; i--) {
-      Element* temp = minHeap[0];
-      minHeap[0] = minHeap[i];
-      minHeap[i] = temp;
+      swapElements(0, i);
       minHeapify(0);
    }
 }
@@ -150,22 +171,37 @@ void MinPriorityQ::minHeapify(int i) {
    unsigned int l = left(i);
    unsigned int r = right(i);
    int smallest;
-   if(l < minHeap.size() && minHeap[l]->key < minHeap[i]->key) {
+   if(l < minHeap.size() && minHeap[l].key < minHeap[i].key) {
       smallest = l;
    } else {
       smallest = i;
    }
-   if(r < minHeap.size() && minHeap[r]->key < minHeap[smallest]->key) {
+   if(r < minHeap.size() && minHeap[r].key < minHeap[smallest].key) {
       smallest = r;
    }
    if(smallest != i) {
-      Element* temp = minHeap[i];
-      minHeap[i] = minHeap[smallest];
-      minHeap[smallest] = temp;
+      swapElements(i, smallest);
       minHeapify(smallest);
    }
 }
 
+/*
+ * @brief Swaps two Elements of the heap
+ *
+ * @param i an integer containing the index of one Element
+ * @param j an integer containing the index of the other Element
+ *
+ * @return nothing
+ *
+ * Every move of an Element goes through here so position always
+ * holds the current slot of each id.
+ */
+void MinPriorityQ::swapElements(int i, int j) {
+   std::swap(minHeap[i], minHeap[j]);
+   position[minHeap[i].id] = i;
+   position[minHeap[j].id] = j;
+}
+
 /*
  * @brief Gets the index of the parent of a given index
  *
@@ -173,9 +209,12 @@ void MinPriorityQ::minHeapify(int i) {
  * to find the parent of
  *
  * @return the index of the parent of the index given
+ *
+ * The children of i are 2i + 1 and 2i + 2, so the parent is
+ * (i - 1) / 2; i / 2 would be wrong for every left child.
  */
 int MinPriorityQ::parent(int i) {
-   int parent = floor(i/2);
+   int parent = (i - 1) / 2;
    return parent;
 }
 
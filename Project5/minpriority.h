@@ -4,34 +4,43 @@
  * @author Katherine Jouzapaitis
  * @date 05/04/2016
  */
+#ifndef CSCI_311_MINPRIORITY_H
+#define CSCI_311_MINPRIORITY_H
+
 #include <cmath>
 #include <vector>
-#include <string>
 #include <climits>
-
-using std::string;
+#include <utility>
 
 class MinPriorityQ {
 public:
    MinPriorityQ(/*int size*/);
    ~MinPriorityQ();
-   void insert(string id, int key);
-   void decreaseKey(string id, int newKey);
-   string extractMin();
-   bool isMember(string id);
+   void insert(int id, int key);
+   void decreaseKey(int id, int newKey);
+   int extractMin();                  // -1 when empty
+   int minKey();                      // INT_MAX when empty
+   bool isMember(int id);
+   void clear();
 private:
    class Element {
    public:
-      string id;
+      int id;
       int key;
    };
    
    //Element[] minHeap;
-   std::vector<Element*> minHeap;
+   std::vector<Element> minHeap;
+   // heap slot of every id, -1 if it is not in minHeap; kept up to
+   // date by swapElements
+   std::vector<int> position;
    
    void buildMinHeap();
    void minHeapify(int i);
+   void swapElements(int i, int j);
    int parent(int i);
    int left(int i);
    int right(int i);
-};
\ No newline at end of file
+};
+
+#endif // CSCI_311_MINPRIORITY_H
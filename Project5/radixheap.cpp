@@ -0,0 +1,96 @@
+/*
+ * @file radixheap.cpp A radix heap, a min priority queue for
+ * non-negative integer keys that never go below the last one taken
+ * out.
+ *
+ * An id whose key goes down is inserted again instead of moved; the
+ * caller skips the stale copy when it comes out, by its key.
+ */
+
+#include "radixheap.h"
+
+/*
+ * @brief Default constructor
+ */
+RadixHeap::RadixHeap() : last(0), count(0) {}
+
+/*
+ * @brief Empties the heap
+ *
+ * @return nothing
+ */
+void RadixHeap::clear() {
+   for(int b = 0; b < BUCKETS; b++) {
+      buckets[b].clear();
+   }
+   last = 0;
+   count = 0;
+}
+
+/*
+ * @brief Inserts an id
+ *
+ * @param id the id, such as a vertex number
+ * @param key its key, no less than the last key taken out
+ *
+ * @return nothing
+ */
+void RadixHeap::insert(int id, int key) {
+   buckets[bucketOf(key)].push_back(std::make_pair((unsigned int)key, id));
+   count++;
+}
+
+/*
+ * @brief Takes out an id with the smallest key
+ *
+ * @param key set to the key of the id taken out
+ *
+ * @return the id, or -1 if the heap is empty
+ *
+ * When bucket 0 is empty, the smallest key is in the first bucket
+ * that is not. It becomes last, and the rest of that bucket moves
+ * down to the buckets that match it now. Each pair only ever moves
+ * down, so it moves at most 32 times.
+ */
+int RadixHeap::extractMin(int& key) {
+   if(count == 0) {
+      return -1;
+   }
+   if(buckets[0].empty()) {
+      int b = 1;
+      while(buckets[b].empty()) {
+         b++;
+      }
+      std::vector<std::pair<unsigned int, int> >& from = buckets[b];
+      last = from[0].first;
+      for(size_t i = 1; i < from.size(); i++) {
+         if(from[i].first < last) {
+            last = from[i].first;
+         }
+      }
+      for(size_t i = 0; i < from.size(); i++) {
+         buckets[bucketOf(from[i].first)].push_back(from[i]);
+      }
+      from.clear();
+   }
+   std::pair<unsigned int, int> top = buckets[0].back();
+   buckets[0].pop_back();
+   count--;
+   key = top.first;
+   return top.second;
+}
+
+/*
+ * @brief Finds the bucket a key belongs in
+ *
+ * @param key a key no less than last
+ *
+ * @return 0 if key is last, otherwise one more than the number of
+ * the highest bit where key and last differ
+ */
+int RadixHeap::bucketOf(unsigned int key) {
+   if(key == last) {
+      return 0;
+   }
+   return 32 - __builtin_clz(key ^ last);
+}
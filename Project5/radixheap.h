@@ -0,0 +1,35 @@
+/*
+ * @file radixheap.h A radix heap, a min priority queue for
+ * non-negative integer keys of any size that never go below the last
+ * one taken out, as in Dijkstra's algorithm.
+ *
+ * Resources:
+ * https://en.wikipedia.org/wiki/Radix_heap
+ */
+
+#ifndef CSCI_311_RADIXHEAP_H
+#define CSCI_311_RADIXHEAP_H
+
+#include <vector>
+#include <cstddef>
+#include <utility>
+
+class RadixHeap {
+public:
+   RadixHeap();
+   void clear();
+   void insert(int id, int key);
+   int extractMin(int& key);          // -1 when empty
+private:
+   static const int BUCKETS = 33;
+
+   // (key, id) pairs; bucket 0 holds the keys equal to last, bucket
+   // b the keys whose highest bit differing from last is bit b - 1
+   std::vector<std::pair<unsigned int, int> > buckets[BUCKETS];
+   unsigned int last;                 // the last key taken out
+   size_t count;                      // ids in the heap
+
+   int bucketOf(unsigned int key);
+};
+
+#endif // CSCI_311_RADIXHEAP_H
@@ -8,6 +8,33 @@
 
 #include "sspapp.h"
 
+/*
+ * @brief Constructor
+ *
+ * @param groupBySource whether processQueries reads every query
+ * first and answers them grouped by source
+ * @param cacheBytes how many bytes of shortest path trees the graph
+ * keeps
+ * @param mode how the graph searches for each path
+ * @param heuristic what A* steers by when mode is ASTAR
+ * @param hierarchyPath where readGraph loads the contraction
+ * hierarchy from, or saves it to after building it; "" for none
+ * @param threadCount how many threads answer the queries; more than
+ * one also groups them by source
+ * @param queue the queue the graph builds shortest path trees with
+ * @param lazyReset whether trees are reset with epoch stamps
+ */
+SSPapp::SSPapp(bool groupBySource, size_t cacheBytes, Graph::Mode mode,
+               Graph::Heuristic heuristic, const string& hierarchyPath,
+               unsigned int threadCount, Graph::Queue queue, bool lazyReset)
+    : groupBySource(groupBySource || threadCount > 1), hierarchyPath(hierarchyPath),
+      threadCount(threadCount), myGraph(cacheBytes) {
+    myGraph.setMode(mode);
+    myGraph.setHeuristic(heuristic);
+    myGraph.setQueue(queue);
+    myGraph.setLazyReset(lazyReset);
+}
+
 /*
  * @brief Processes input to build the lists of vertices and
  * weighted edges
@@ -16,28 +43,67 @@
  *
  * Uses std cin to get input. First input the number of vertices,
  * next a string with all the vertex names, next the number of
- * weighted edges, then looped through to get the edges.
+ * weighted edges, then looped through to get the edges. The edges
+ * are read straight from std cin into reused strings, and the graph
+ * is packed once they are all in.
+ *
+ * If the number of vertices is followed by the word "coords" on its
+ * line, each vertex name is instead followed by its x and y
+ * coordinates, one vertex per line, for A* to steer by. Only that
+ * one word is looked at, so vertex names may still start on the
+ * count line as before.
+ *
+ * With a hierarchy file, the contraction hierarchy is loaded from it
+ * if it was saved for this same graph, and otherwise built and saved
+ * there for next time.
  */
 void SSPapp::readGraph() {
     int vertNum;
     std::cin >> vertNum;
+    while(std::cin.peek() == ' ' || std::cin.peek() == '\t' || std::cin.peek() == '\r') {
+        std::cin.get();
+    }
     string line;
-    for(int i = 0; i < vertNum; i++) {
+    bool coords = false;
+    int i = 0;
+    if(std::cin.peek() != '\n' && std::cin.peek() != EOF && vertNum > 0) {
         std::cin >> line;
-        myGraph.addVertex(line);
+        if(line == "coords") {
+            coords = true;
+        } else {
+            myGraph.addVertex(line);
+            i = 1;
+        }
+    }
+    double x;
+    double y;
+    for(; i < vertNum; i++) {
+        std::cin >> line;
+        if(coords) {
+            std::cin >> x >> y;
+            myGraph.addVertex(line, x, y);
+        } else {
+            myGraph.addVertex(line);
+        }
     }
     int edgeNum;
     std::cin >> edgeNum;
+    myGraph.reserve(vertNum, edgeNum);
     string to;
     string from;
     int dist;
-    std::getline(std::cin, line);
     for(int i = 0; i < edgeNum; i++) {
-        std::getline(std::cin, line);
-        std::istringstream input(line);
-        input >> from >> to >> dist;
+        std::cin >> from >> to >> dist;
         myGraph.addEdge(from, to, dist);
     }
+    std::getline(std::cin, line);
+    myGraph.finalize();
+    if(!hierarchyPath.empty() && !myGraph.loadHierarchy(hierarchyPath)) {
+        myGraph.buildHierarchy();
+        if(!myGraph.saveHierarchy(hierarchyPath)) {
+            std::cerr << "could not write " << hierarchyPath << std::endl;
+        }
+    }
 }
 
 /*
@@ -47,21 +113,163 @@ void SSPapp::readGraph() {
  * @return nothing
  *
  * Using std cin for input. The line gets separated into
- * two different strings to call getShortestPath.
+ * two different strings to call getShortestPath. When grouping by
+ * source, every query is read first and the queries are answered
+ * sorted by source, so each source's tree is built once however
+ * small the cache; the answers are still printed in input order.
+ * With more than one thread, the groups are shared out among them.
  */
 void SSPapp::processQueries() {
     string line;
     string from;
     string to;
+    if(!groupBySource) {
+        while(std::getline(std::cin, line)) {
+            std::istringstream input(line);
+            input >> from >> to;
+            std::cout << myGraph.getShortestPath(from, to) << std::endl;
+        }
+        return;
+    }
+
+    vector<std::pair<string, string> > queries;
     while(std::getline(std::cin, line)) {
         std::istringstream input(line);
+        from.clear();
+        to.clear();
         input >> from >> to;
-        std::cout << myGraph.getShortestPath(from, to) << std::endl;
+        queries.push_back(std::make_pair(from, to));
+    }
+    vector<int> order(queries.size());
+    for(size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&queries](int lhs, int rhs) {
+        return (queries[lhs].first < queries[rhs].first);
+    });
+    vector<string> answers(queries.size());
+    if(threadCount > 1) {
+        answerInParallel(queries, order, answers);
+    } else {
+        for(size_t i = 0; i < order.size(); i++) {
+            const std::pair<string, string>& query = queries[order[i]];
+            answers[order[i]] = myGraph.getShortestPath(query.first, query.second);
+        }
+    }
+    for(size_t i = 0; i < answers.size(); i++) {
+        std::cout << answers[i] << '\n';
+    }
+    std::cout.flush();
+}
+
+/*
+ * @brief Answers queries sorted by source on threadCount threads
+ *
+ * @param queries the from and to names of each query
+ * @param order the query numbers sorted by source
+ * @param answers filled with the answer to each query, by query
+ * number
+ *
+ * @return nothing
+ *
+ * The graph is prepared once, then only read. Each thread takes the
+ * next group of queries with the same source until none are left,
+ * searching in its own workspace, so in TREE mode each source's tree
+ * is built once by whichever thread took it. Every answer goes in its
+ * own slot, so the threads never write to the same place.
+ */
+void SSPapp::answerInParallel(const vector<std::pair<string, string> >& queries,
+                              const vector<int>& order, vector<string>& answers) {
+    vector<size_t> groups;
+    for(size_t i = 0; i < order.size(); i++) {
+        if(i == 0 || queries[order[i]].first != queries[order[i - 1]].first) {
+            groups.push_back(i);
+        }
+    }
+    groups.push_back(order.size());
+
+    myGraph.prepare();
+    const Graph& graph = myGraph;
+    std::atomic<size_t> nextGroup(0);
+    vector<std::thread> threads;
+    for(unsigned int t = 0; t < threadCount; t++) {
+        threads.push_back(std::thread([&]() {
+            Graph::Workspace workspace;
+            for(size_t g = nextGroup++; g + 1 < groups.size(); g = nextGroup++) {
+                for(size_t i = groups[g]; i < groups[g + 1]; i++) {
+                    const std::pair<string, string>& query = queries[order[i]];
+                    answers[order[i]] = graph.getShortestPath(query.first, query.second,
+                                                              workspace);
+                }
+            }
+        }));
+    }
+    for(unsigned int t = 0; t < threadCount; t++) {
+        threads[t].join();
     }
 }
 
-int main() {
-    SSPapp app;
+int main(int argc, char** argv) {
+    std::ios::sync_with_stdio(false);
+    bool groupBySource = false;
+    size_t cacheBytes = Graph::DEFAULT_CACHE_BYTES;
+    Graph::Mode mode = Graph::TREE;
+    Graph::Heuristic heuristic = Graph::EUCLIDEAN;
+    string hierarchyPath;
+    unsigned int threadCount = 1;
+    Graph::Queue queue = Graph::BINARY_HEAP;
+    bool lazyReset = false;
+    for(int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if(arg == "-g") {
+            groupBySource = true;
+        } else if(arg == "-l") {
+            lazyReset = true;
+        } else if(arg == "-e") {
+            mode = Graph::EARLY_EXIT;
+        } else if(arg == "-b") {
+            mode = Graph::BIDIRECTIONAL;
+        } else if(arg == "-c" && i + 1 < argc) {
+            mode = Graph::CONTRACTED;
+            hierarchyPath = argv[++i];
+        } else if(arg == "-a" && i + 1 < argc) {
+            mode = Graph::ASTAR;
+            string name = argv[++i];
+            if(name == "euclidean") {
+                heuristic = Graph::EUCLIDEAN;
+            } else if(name == "manhattan") {
+                heuristic = Graph::MANHATTAN;
+            } else if(name == "landmarks") {
+                heuristic = Graph::LANDMARKS;
+            } else {
+                std::cerr << "unknown heuristic " << name << std::endl;
+                return 1;
+            }
+        } else if(arg == "-q" && i + 1 < argc) {
+            string name = argv[++i];
+            if(name == "heap") {
+                queue = Graph::BINARY_HEAP;
+            } else if(name == "buckets") {
+                queue = Graph::BUCKETS;
+            } else if(name == "radix") {
+                queue = Graph::RADIX_HEAP;
+            } else {
+                std::cerr << "unknown queue " << name << std::endl;
+                return 1;
+            }
+        } else if(arg == "-t" && i + 1 < argc) {
+            threadCount = std::max(1, atoi(argv[++i]));
+        } else if(arg == "-m" && i + 1 < argc) {
+            cacheBytes = (size_t)std::strtoull(argv[++i], nullptr, 10) << 20;
+        } else {
+            std::cerr << "usage: " << argv[0] << " [-g] [-l]"
+                      << " [-e | -b | -a euclidean|manhattan|landmarks | -c hierarchy]"
+                      << " [-q heap|buckets|radix] [-m megabytes] [-t threads]" << std::endl;
+            return 1;
+        }
+    }
+    SSPapp app(groupBySource, cacheBytes, mode, heuristic, hierarchyPath, threadCount,
+               queue, lazyReset);
     app.readGraph();
     app.processQueries();
     return 0;
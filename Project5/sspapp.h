@@ -8,12 +8,29 @@
 
 #include <iostream>
 #include <fstream>
+#include <cstdlib>
+#include <thread>
+#include <atomic>
 #include "graph.h"
 
 class SSPapp {
    public:
+      SSPapp(bool groupBySource = false,
+             size_t cacheBytes = Graph::DEFAULT_CACHE_BYTES,
+             Graph::Mode mode = Graph::TREE,
+             Graph::Heuristic heuristic = Graph::EUCLIDEAN,
+             const string& hierarchyPath = "",
+             unsigned int threadCount = 1,
+             Graph::Queue queue = Graph::BINARY_HEAP,
+             bool lazyReset = false);
       void readGraph();
       void processQueries();
    private:
+      bool groupBySource;      // answer queries grouped by source
+      string hierarchyPath;    // contraction hierarchy file, if any
+      unsigned int threadCount;    // threads answering grouped queries
       Graph myGraph;
+
+      void answerInParallel(const vector<std::pair<string, string> >& queries,
+                            const vector<int>& order, vector<string>& answers);
 };
\ No newline at end of file
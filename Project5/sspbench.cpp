@@ -0,0 +1,271 @@
+/*
+ * @file sspbench.cpp Measures how fast Graph loads a graph and finds
+ * shortest paths.
+ *
+ * @brief Makes two graphs for each size given. One is random and
+ * strongly connected: every vertex has an edge to the next one around
+ * a cycle plus EXTRA_EDGES edges to random vertices, all with random
+ * weights. The other is a square grid with coordinates. For each,
+ * times loading it through addVertex, addEdge and finalize, and
+ * SOURCES queries from different sources in each of Graph's modes:
+ * building a whole shortest path tree per query, stopping at the
+ * target, searching from both ends, A* with each heuristic that
+ * applies, and a contraction hierarchy for grids up to
+ * HIERARCHY_LIMIT vertices. Last, times building shortest path trees
+ * with each of Graph's queues, and with the binary heap and lazy
+ * reset, on random graphs with weights up to SMALL_WEIGHT and up to
+ * LARGE_WEIGHT.
+ *
+ * Usage: sspbench [vertices...]
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include "graph.h"
+
+using std::cout;
+
+typedef std::chrono::steady_clock Clock;
+
+// random edges out of every vertex besides the cycle edge
+static const int EXTRA_EDGES = 3;
+// queries timed per size and mode
+static const int SOURCES = 5;
+// distance between neighbours in the grid graphs
+static const int GRID_SPACING = 10;
+// largest grid a contraction hierarchy is built for, as it takes
+// minutes beyond this
+static const int HIERARCHY_LIMIT = 200000;
+// heaviest weights of the random graphs the queues are compared on;
+// the buckets queue keeps one bucket per weight
+static const int SMALL_WEIGHT = 10;
+static const int LARGE_WEIGHT = 1000000;
+
+/*
+ * @brief Gets the seconds since a point in time.
+ *
+ * @param start when the timing began
+ *
+ * @return the seconds elapsed
+ */
+double secondsSince(Clock::time_point start) {
+   return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/*
+ * @brief Times SOURCES random queries in each of Graph's modes.
+ *
+ * @param graph the loaded graph
+ * @param names the names of its vertices
+ * @param gen the random numbers to pick the queries with
+ * @param geometric whether the vertices have coordinates, so the
+ * geometric A* heuristics are worth timing; only these road-like
+ * graphs get a contraction hierarchy, which on a random graph would
+ * need shortcuts between nearly every pair of vertices left
+ */
+void timeQueries(Graph& graph, const vector<string>& names, std::mt19937& gen,
+                 bool geometric) {
+   int vertexCount = names.size();
+   std::uniform_int_distribution<int> vertex(0, vertexCount - 1);
+   vector<int> from(SOURCES);
+   vector<int> to(SOURCES);
+   for(int q = 0; q < SOURCES; q++) {
+      from[q] = vertex(gen);
+      to[q] = (from[q] + 1 + vertex(gen) % (vertexCount - 1)) % vertexCount;
+   }
+   const Graph::Mode modes[] = {Graph::TREE, Graph::EARLY_EXIT, Graph::BIDIRECTIONAL,
+                                Graph::ASTAR, Graph::ASTAR, Graph::ASTAR,
+                                Graph::CONTRACTED};
+   const Graph::Heuristic heuristics[] = {Graph::EUCLIDEAN, Graph::EUCLIDEAN,
+                                          Graph::EUCLIDEAN, Graph::EUCLIDEAN,
+                                          Graph::MANHATTAN, Graph::LANDMARKS,
+                                          Graph::EUCLIDEAN};
+   const char* labels[] = {"shortest path tree", "early exit", "bidirectional",
+                           "A* euclidean", "A* manhattan", "A* landmarks",
+                           "contraction hierarchy"};
+   for(int m = 0; m < 7; m++) {
+      if(!geometric && modes[m] == Graph::ASTAR && heuristics[m] != Graph::LANDMARKS) {
+         continue;
+      }
+      if(modes[m] == Graph::CONTRACTED && (!geometric || vertexCount > HIERARCHY_LIMIT)) {
+         continue;
+      }
+      graph.setMode(modes[m]);
+      graph.setHeuristic(heuristics[m]);
+      Clock::time_point start = Clock::now();
+      graph.getShortestPath(names[0], names[0]);
+      if(modes[m] == Graph::ASTAR || modes[m] == Graph::CONTRACTED) {
+         cout << "   " << labels[m] << " setup: " << secondsSince(start) << " s\n";
+      }
+      start = Clock::now();
+      size_t pathLength = 0;
+      for(int q = 0; q < SOURCES; q++) {
+         pathLength += graph.getShortestPath(names[from[q]], names[to[q]]).size();
+      }
+      cout << "   " << labels[m] << ": " << secondsSince(start) / SOURCES << " s each\n";
+      if(pathLength == 0) {
+         cout << "   no paths!\n";
+      }
+   }
+}
+
+/*
+ * @brief Gives every vertex a name.
+ *
+ * @param vertexCount the number of vertices
+ *
+ * @return "v0", "v1", ...
+ */
+vector<string> makeNames(int vertexCount) {
+   vector<string> names(vertexCount);
+   for(int i = 0; i < vertexCount; i++) {
+      names[i] = "v" + std::to_string(i);
+   }
+   return names;
+}
+
+/*
+ * @brief Adds the vertices and edges of a random graph.
+ *
+ * @param graph the graph to add to
+ * @param names the names of its vertices
+ * @param maxWeight the heaviest weight an edge may have
+ * @param gen the random numbers to make the edges with
+ */
+void loadRandom(Graph& graph, const vector<string>& names, int maxWeight,
+                std::mt19937& gen) {
+   int vertexCount = names.size();
+   std::uniform_int_distribution<int> vertex(0, vertexCount - 1);
+   std::uniform_int_distribution<int> weight(1, maxWeight);
+   graph.reserve(vertexCount, vertexCount * (EXTRA_EDGES + 1));
+   for(int i = 0; i < vertexCount; i++) {
+      graph.addVertex(names[i]);
+   }
+   for(int i = 0; i < vertexCount; i++) {
+      graph.addEdge(names[i], names[(i + 1) % vertexCount], weight(gen));
+      for(int j = 0; j < EXTRA_EDGES; j++) {
+         graph.addEdge(names[i], names[vertex(gen)], weight(gen));
+      }
+   }
+   graph.finalize();
+}
+
+/*
+ * @brief Loads a random graph and times queries on it.
+ *
+ * @param vertexCount the number of vertices in the graph
+ */
+void measure(int vertexCount) {
+   std::mt19937 gen(311);
+   vector<string> names = makeNames(vertexCount);
+
+   Graph graph;
+   Clock::time_point start = Clock::now();
+   loadRandom(graph, names, 100, gen);
+   double loadSeconds = secondsSince(start);
+   cout << vertexCount << " vertices, " << vertexCount * (EXTRA_EDGES + 1)
+        << " edges\n";
+   cout << "   load: " << loadSeconds << " s\n";
+   timeQueries(graph, names, gen, false);
+}
+
+/*
+ * @brief Loads a square grid with coordinates, like a road map, and
+ * times queries on it.
+ *
+ * @param vertexCount about the number of vertices in the graph
+ *
+ * Neighbours across and down are joined both ways by an edge a bit
+ * longer than the GRID_SPACING between them.
+ */
+void measureGrid(int vertexCount) {
+   int side = std::max(2, (int)std::sqrt((double)vertexCount));
+   vertexCount = side * side;
+   std::mt19937 gen(311);
+   std::uniform_int_distribution<int> detour(0, GRID_SPACING);
+   vector<string> names = makeNames(vertexCount);
+
+   Graph graph;
+   Clock::time_point start = Clock::now();
+   graph.reserve(vertexCount, 4 * vertexCount);
+   for(int i = 0; i < vertexCount; i++) {
+      graph.addVertex(names[i], GRID_SPACING * (i % side), GRID_SPACING * (i / side));
+   }
+   for(int i = 0; i < vertexCount; i++) {
+      int across = (i % side + 1 < side) ? i + 1 : -1;
+      int down = (i + side < vertexCount) ? i + side : -1;
+      int neighbours[] = {across, down};
+      for(int n = 0; n < 2; n++) {
+         if(neighbours[n] != -1) {
+            graph.addEdge(names[i], names[neighbours[n]], GRID_SPACING + detour(gen));
+            graph.addEdge(names[neighbours[n]], names[i], GRID_SPACING + detour(gen));
+         }
+      }
+   }
+   graph.finalize();
+   cout << side << " x " << side << " grid\n";
+   cout << "   load: " << secondsSince(start) << " s\n";
+   timeQueries(graph, names, gen, true);
+}
+
+/*
+ * @brief Times building shortest path trees with each of Graph's
+ * queues, and with lazy reset, on random graphs with small and with
+ * large weights.
+ *
+ * @param vertexCount the number of vertices in the graphs
+ *
+ * Each query is from a new source, and the cache only holds one
+ * tree, so every query builds a tree.
+ */
+void measureQueues(int vertexCount) {
+   const int maxWeights[] = {SMALL_WEIGHT, LARGE_WEIGHT};
+   const Graph::Queue queues[] = {Graph::BINARY_HEAP, Graph::BINARY_HEAP, Graph::BUCKETS,
+                                  Graph::RADIX_HEAP};
+   const bool lazy[] = {false, true, false, false};
+   const char* labels[] = {"binary heap", "binary heap, lazy reset", "buckets",
+                           "radix heap"};
+   vector<string> names = makeNames(vertexCount);
+   for(int w = 0; w < 2; w++) {
+      std::mt19937 gen(311);
+      Graph graph(0);
+      loadRandom(graph, names, maxWeights[w], gen);
+      cout << vertexCount << " vertices, weights up to " << maxWeights[w] << "\n";
+      for(int q = 0; q < 4; q++) {
+         graph.setQueue(queues[q]);
+         graph.setLazyReset(lazy[q]);
+         Clock::time_point start = Clock::now();
+         size_t pathLength = 0;
+         for(int i = 0; i < SOURCES; i++) {
+            pathLength += graph.getShortestPath(names[i], names[vertexCount - 1]).size();
+         }
+         cout << "   tree with " << labels[q] << ": " << secondsSince(start) / SOURCES
+              << " s each\n";
+         if(pathLength == 0) {
+            cout << "   no paths!\n";
+         }
+      }
+   }
+}
+
+int main(int argc, char** argv) {
+   vector<int> sizes;
+   for(int i = 1; i < argc; i++) {
+      sizes.push_back(atoi(argv[i]));
+   }
+   if(sizes.empty()) {
+      sizes.push_back(100000);
+   }
+   for(size_t i = 0; i < sizes.size(); i++) {
+      measure(sizes[i]);
+      measureGrid(sizes[i]);
+      measureQueues(sizes[i]);
+   }
+   return 0;
+}